@@ -42,13 +42,6 @@ class AtomicProposition : public CltlFormula {
 
     void accept(CltlFormulaVisitor &visitor) override;
 
-    inline std::size_t height() const { return 1; }
-
-    inline bool is_infltl() const { return true; }
-    inline bool is_supltl() const { return true; }
-    inline bool is_propositional() const { return true; }
-    inline bool is_nnf() const { return true; }
-
     std::string dump() const override;
 
  protected:
@@ -58,6 +51,11 @@ class AtomicProposition : public CltlFormula {
  private:
     friend class CltlFormulaFactory;
     std::string _value;
+
+    /// Computes the structural hash of the atomic proposition `value`, without building it.
+    static std::size_t _make_hash(const std::string &value);
+    /// Returns whether or not `formula` is the atomic proposition `value`.
+    static bool _is_same(const CltlFormula &formula, const std::string &value);
 };
 
 }  // namespace spaction
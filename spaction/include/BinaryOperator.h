@@ -59,13 +59,6 @@ class BinaryOperator : public CltlFormula {
 
     void accept(CltlFormulaVisitor &visitor) override;
 
-    inline std::size_t height() const { return 1 + std::max(_left->height(), _right->height()); }
-
-    bool is_infltl() const;
-    bool is_supltl() const;
-    bool is_propositional() const;
-    bool is_nnf() const;
-
     std::string dump() const override;
 
  protected:
@@ -89,7 +82,25 @@ class BinaryOperator : public CltlFormula {
     /// @warning
     ///     The result of this method is valid only if the `_type` of this formula is an operator
     ///     of propositional logic.
-    std::unordered_multiset<const CltlFormula*> _leaves() const;
+    std::unordered_multiset<const CltlFormula*> _leaves() const {
+        return _leaves(_type, _left.get(), _right.get());
+    }
+
+    /// Retrieves the leaves of the binary operation `type` applied to `left` and `right`.
+    static std::unordered_multiset<const CltlFormula*> _leaves(BinaryOperatorType type,
+                                                               const CltlFormula *left,
+                                                               const CltlFormula *right);
+
+    /// Computes the structural hash of a binary operation, without building it.
+    /// @remarks
+    ///     The hash of a disjunction (resp. conjunction) is a commutative combination of the
+    ///     hashes of its leaves, so that it agrees with `syntactic_eq`.
+    static std::size_t _make_hash(BinaryOperatorType type, const CltlFormulaPtr &left,
+                                  const CltlFormulaPtr &right);
+    /// Returns whether or not `formula` is the binary operation `type` applied to `left` and
+    /// `right`.
+    static bool _is_same(const CltlFormula &formula, BinaryOperatorType type,
+                         const CltlFormulaPtr &left, const CltlFormulaPtr &right);
 };
 
 }  // namespace spaction
@@ -18,6 +18,7 @@
 #ifndef SPACTION_INCLUDE_CLTLFORMULA_H_
 #define SPACTION_INCLUDE_CLTLFORMULA_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -53,6 +54,12 @@ class CltlFormula : public std::enable_shared_from_this<CltlFormula> {
     /// Returns whether or not `rhs` is syntactically equivalent to this formula.
     virtual inline bool syntactic_eq(const CltlFormula &rhs) const = 0;
 
+    /// Returns the structural hash of the formula.
+    /// @remarks
+    ///     The hash is computed once at construction, from the type of the formula and the
+    ///     identity of its subformulae. Syntactically equivalent formulae have the same hash.
+    inline std::size_t hash() const { return _hash; }
+
     /// Returns a equivalent formula in negation normal form.
     virtual inline CltlFormulaPtr to_nnf() { return shared_from_this(); }
 
@@ -69,18 +76,18 @@ class CltlFormula : public std::enable_shared_from_this<CltlFormula> {
     ///
     /// Height of a formula is `1` for an atomic proposition, or the highest height within its
     /// subformulae + `1`.
-    virtual std::size_t height() const = 0;
+    inline std::size_t height() const { return _height; }
 
     /// Indicates whether the formula is LTL[<=]
-    virtual bool is_infltl() const = 0;
+    inline bool is_infltl() const { return _is_infltl; }
     /// Indicates whether the formula is LTL[>]
-    virtual bool is_supltl() const = 0;
+    inline bool is_supltl() const { return _is_supltl; }
     /// Indicates whether the formula is LTL (i.e. both LTL[<=] and LTL[>])
-    bool is_ltl() const { return is_infltl() and is_supltl(); }
+    inline bool is_ltl() const { return is_infltl() and is_supltl(); }
     /// Indicates whether the formula is propositional (i.e. has no temporal operator)
-    virtual bool is_propositional() const = 0;
+    inline bool is_propositional() const { return _is_propositional; }
     /// Indicates whether the formula is in NNF
-    virtual bool is_nnf() const = 0;
+    inline bool is_nnf() const { return _is_nnf; }
 
     /// Returns a string representation of the formula.
     virtual std::string dump() const = 0;
@@ -88,8 +95,22 @@ class CltlFormula : public std::enable_shared_from_this<CltlFormula> {
  protected:
     CltlFormulaFactory *_creator;
 
+    /// Structural attributes of the formula.
+    /// @remarks
+    ///     They default to the attributes of an atomic proposition, and are computed once and for
+    ///     all by the constructors of the subclasses.
+    //@{
+    unsigned int _height;
+    bool _is_infltl : 1;
+    bool _is_supltl : 1;
+    bool _is_propositional : 1;
+    bool _is_nnf : 1;
+    //@}
+
     /// Class constructor.
-    explicit CltlFormula(CltlFormulaFactory *creator) : _creator(creator) { }
+    explicit CltlFormula(CltlFormulaFactory *creator, std::size_t hash) :
+        _creator(creator), _height(1), _is_infltl(true), _is_supltl(true),
+        _is_propositional(true), _is_nnf(true), _hash(hash) { }
 
     /// Virtual destructor.
     ///
@@ -105,8 +126,24 @@ class CltlFormula : public std::enable_shared_from_this<CltlFormula> {
 
  private:
     friend class CltlFormulaFactory;
+
+    const std::size_t _hash;
 };
 
 }  // namespace spaction
 
+namespace std {
+
+/// Formulae are unique (see CltlFormulaFactory), so that their structural hash is consistent with
+/// the equality of pointers, and is better distributed than their address.
+template<>
+struct hash<spaction::CltlFormulaPtr> {
+    typedef spaction::CltlFormulaPtr argument_type;
+    typedef std::size_t result_type;
+
+    result_type operator()(const argument_type &f) const { return f ? f->hash() : 0; }
+};
+
+}  // namespace std
+
 #endif  // SPACTION_INCLUDE_CLTLFORMULA_H_
@@ -18,17 +18,44 @@
 #ifndef SPACTION_INCLUDE_CLTLFORMULAFACTORY_H_
 #define SPACTION_INCLUDE_CLTLFORMULAFACTORY_H_
 
-#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "BinaryOperator.h"
 #include "CltlFormula.h"
+#include "SlabArena.h"
 #include "UnaryOperator.h"
 
 namespace spaction {
 
 /// A factory class for Cost LTL formulae.
+/// @remarks
+///     Formulae may be built from several threads at once (see ConjunctionTranslator).
 class CltlFormulaFactory {
  public:
+    /// Enumeration of the ways a factory may allocate its formulae.
+    enum AllocationPolicy : char {
+        /// Each formula is allocated on its own, and destroyed once it is no more referenced.
+        kHeapAllocation,
+        /// Formulae are allocated from a slab arena owned by the factory. They are never
+        /// destroyed individually, but all at once when the factory is destroyed.
+        kArenaAllocation
+    };
+
+    explicit CltlFormulaFactory(AllocationPolicy policy = kHeapAllocation);
+
+    /// Class destructor.
+    /// @warning
+    ///     The formulae built by this factory must not outlive it.
+    ~CltlFormulaFactory();
+
+    /// Copy construction is forbidden.
+    CltlFormulaFactory(const CltlFormulaFactory &) = delete;
+    /// Copy assignment is forbidden.
+    CltlFormulaFactory &operator=(const CltlFormulaFactory &) = delete;
+
     CltlFormulaPtr make_atomic(const std::string &value);
     CltlFormulaPtr make_constant(bool value);
 
@@ -57,20 +84,94 @@ class CltlFormulaFactory {
     /// Builds a formula semantically equivalent to "Globally^N `formula`".
     CltlFormulaPtr make_costglobally(const CltlFormulaPtr &formula);
 
+    /// Returns a formula equivalent to `formula`, in negation normal form.
+    /// @remarks
+    ///     Normal forms are memoized for each formula, so normalizing a formula costs linear time
+    ///     in the number of its distinct subformulae, and is constant time once done.
+    CltlFormulaPtr make_nnf(const CltlFormulaPtr &formula);
+    /// Returns a formula equivalent to `formula`, in disjunctive normal form.
+    CltlFormulaPtr make_dnf(const CltlFormulaPtr &formula);
+
  private:
-    /// Stores the unique index.
-    std::unordered_set<CltlFormula*> _formulae;
+    /// Guards the unique index and the formulae of the arena.
+    /// @remarks
+    ///     It is only held to look up or update the index, never while a formula is released, so
+    ///     that threads building distinct formulae hardly contend for it.
+    std::mutex _index_mutex;
+    /// Guards the memoized normal forms.
+    /// @remarks
+    ///     The mutex is recursive, since normal forms are computed recursively.
+    std::recursive_mutex _normal_forms_mutex;
+
+    /// An entry of the unique index.
+    /// @remarks
+    ///     The weak reference tells whether the formula is still alive, since the formula stays in
+    ///     the index until its deleter removes it.
+    struct _IndexEntry {
+        CltlFormula *formula;
+        std::weak_ptr<CltlFormula> reference;
+    };
+    /// Stores the unique index, keyed by the structural hash of the formulae.
+    std::unordered_multimap<std::size_t, _IndexEntry> _formulae;
+
+    /// The arena the formulae are allocated from, if any.
+    std::unique_ptr<SlabArena> _arena;
+    /// Keeps every formula allocated in the arena alive until the factory is destroyed.
+    /// @remarks
+    ///     Formulae are stored in their order of creation, so operands always precede the
+    ///     formulae that refer to them.
+    std::vector<CltlFormulaPtr> _arena_formulae;
+
+    /// The normal forms computed so far for a given formula.
+    /// @remarks
+    ///     Normal forms are weakly referenced, so the memo table never keeps a formula alive.
+    struct _NormalForms {
+        std::weak_ptr<CltlFormula> nnf;
+        std::weak_ptr<CltlFormula> dnf;
+        std::weak_ptr<CltlFormula> negated_nnf;
+    };
+    /// Stores the memoized normal forms, keyed by formula.
+    std::unordered_map<const CltlFormula*, _NormalForms> _normal_forms;
 
-    CltlFormulaPtr _make_shared_formula(CltlFormula *formula);
+    /// Returns a formula equivalent to the negation of `formula`, in negation normal form.
+    CltlFormulaPtr _make_negated_nnf(const CltlFormulaPtr &formula);
+
+    /// Returns the formula of type `T` built from `args`.
+    /// @remarks
+    ///     The unique index is looked up before anything gets allocated, so that a new formula
+    ///     is only created if no syntactically equivalent one exists yet.
+    template<typename T, typename... Args>
+    CltlFormulaPtr _make_shared_formula(const Args &...args);
 
     /// Removes a formula from the unique index once it is no more referenced.
     /// @remarks
     ///     This custom deleter is bound to the shared pointers built by this factory. It gets
     ///     called when the references counter of a particular shared pointer reaches 0.
     void _deleter(CltlFormula *formula) {
-        _formulae.erase(formula);
+        {
+            std::lock_guard<std::mutex> lock(_index_mutex);
+            auto range = _formulae.equal_range(formula->hash());
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.formula == formula) {
+                    _formulae.erase(it);
+                    break;
+                }
+            }
+        }
+        {
+            std::lock_guard<std::recursive_mutex> lock(_normal_forms_mutex);
+            _normal_forms.erase(formula);
+        }
+        // releasing the operands calls their deleters, hence no lock is held here
         delete formula;
     }
+
+    /// Deleter of the formulae allocated in the arena.
+    /// @remarks
+    ///     It does nothing, since those formulae are released by the destructor of the factory.
+    struct _ArenaDeleter {
+        void operator()(CltlFormula *) const { }
+    };
 };
 
 }  // namespace spaction
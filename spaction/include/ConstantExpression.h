@@ -42,13 +42,6 @@ class ConstantExpression : public CltlFormula {
 
     void accept(CltlFormulaVisitor &visitor) override;
 
-    inline std::size_t height() const { return 1; }
-
-    inline bool is_infltl() const { return true; }
-    inline bool is_supltl() const { return true; }
-    inline bool is_propositional() const { return true; }
-    inline bool is_nnf() const { return true; }
-
     std::string dump() const override;
 
  protected:
@@ -58,6 +51,11 @@ class ConstantExpression : public CltlFormula {
  private:
     friend class CltlFormulaFactory;
     bool _value;
+
+    /// Computes the structural hash of the constant `value`, without building it.
+    static std::size_t _make_hash(bool value);
+    /// Returns whether or not `formula` is the constant `value`.
+    static bool _is_same(const CltlFormula &formula, bool value);
 };
 
 }  // namespace spaction
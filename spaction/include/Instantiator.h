@@ -18,7 +18,11 @@
 #ifndef SPACTION_INCLUDE_INSTANTIATOR_H_
 #define SPACTION_INCLUDE_INSTANTIATOR_H_
 
+#include <unordered_map>
+#include <utility>
+
 #include "CltlFormulaVisitor.h"
+#include "hash/hash.h"
 
 namespace spaction {
 
@@ -31,9 +35,14 @@ class Instantiator : public CltlFormulaVisitor {
     /// @param formula  a CLTL formula to instantiate
     /// @param n        a non-negative integer
     /// @return         g LTL formula s.t. for all word u, u |= g iff (u,n) |= formula
+    /// @remarks
+    ///     Instantiations are memoized for every pair (subformula, n) met, so that the shared
+    ///     subformulae and the successive unfoldings of cost operators are instantiated only once,
+    ///     including across calls.
     CltlFormulaPtr operator()(const CltlFormulaPtr &formula, unsigned int n);
 
-    virtual Instantiator *copy() const = 0;
+    /// Forgets the memoized instantiations.
+    void clear_cache() { _cache.clear(); }
 
     virtual void visit(const std::shared_ptr<AtomicProposition> &formula) final;
     virtual void visit(const std::shared_ptr<ConstantExpression> &formula) final;
@@ -44,6 +53,9 @@ class Instantiator : public CltlFormulaVisitor {
     unsigned int _n;
     CltlFormulaPtr _result;
 
+    /// Instantiates `formula` with `n`, or returns the memoized result if any.
+    CltlFormulaPtr _instantiate(const CltlFormulaPtr &formula, unsigned int n);
+
     /// Handles the rewriting of Cost Until formulae.
     /// @remarks
     ///     This class should be implemented to specify the behaviour of the Cost Until operator
@@ -52,8 +64,7 @@ class Instantiator : public CltlFormulaVisitor {
     ///     \a left and \a right are assumed to be LTL formulae (already instantiated)
     virtual CltlFormulaPtr _rewrite_cost_until(const CltlFormulaPtr &formula,
                                                const CltlFormulaPtr &left,
-                                               const CltlFormulaPtr &right,
-                                               Instantiator *instantiator) const = 0;
+                                               const CltlFormulaPtr &right) = 0;
     /// Handles the rewriting of Cost Release formulae.
     /// @remarks
     ///     This class should be implemented to specify the behaviour of the Cost Release operator
@@ -62,47 +73,40 @@ class Instantiator : public CltlFormulaVisitor {
     ///     \a left and \a right are assumed to be LTL formulae (already instantiated)
     virtual CltlFormulaPtr _rewrite_cost_release(const CltlFormulaPtr &formula,
                                                  const CltlFormulaPtr &left,
-                                                 const CltlFormulaPtr &right,
-                                                 Instantiator *instantiator) const = 0;
+                                                 const CltlFormulaPtr &right) = 0;
 
     /// A hook for preprocessing.
     virtual void _preprocess(const CltlFormulaPtr &formula, unsigned int n) const { }
+
+ private:
+    /// Stores the memoized instantiations, keyed by subformula and integer.
+    std::unordered_map<std::pair<CltlFormulaPtr, unsigned int>, CltlFormulaPtr> _cache;
 };
 
 /// Instantiate a CLTL[<=] formula (raise an exception if a Cost Release is encountered)
 class InstantiateInf : public Instantiator {
- public:
-    virtual inline Instantiator *copy() const { return new InstantiateInf(); }
-
  protected:
     virtual CltlFormulaPtr _rewrite_cost_until(const CltlFormulaPtr &formula,
                                                const CltlFormulaPtr &left,
-                                               const CltlFormulaPtr &right,
-                                               Instantiator *instantiator) const;
+                                               const CltlFormulaPtr &right);
 
     virtual CltlFormulaPtr _rewrite_cost_release(const CltlFormulaPtr &formula,
                                                  const CltlFormulaPtr &left,
-                                                 const CltlFormulaPtr &right,
-                                                 Instantiator *instantiator) const;
+                                                 const CltlFormulaPtr &right);
 
     virtual void _preprocess(const CltlFormulaPtr &formula, unsigned int n) const override;
 };
 
 /// Instantiate a CLTL[>] formula (raise an exception if a Cost Until is encountered)
 class InstantiateSup : public Instantiator {
- public:
-    virtual inline Instantiator *copy() const { return new InstantiateSup(); }
-
  protected:
     virtual CltlFormulaPtr _rewrite_cost_until(const CltlFormulaPtr &formula,
                                                const CltlFormulaPtr &left,
-                                               const CltlFormulaPtr &right,
-                                               Instantiator *instantiator) const;
+                                               const CltlFormulaPtr &right);
 
     virtual CltlFormulaPtr _rewrite_cost_release(const CltlFormulaPtr &formula,
                                                  const CltlFormulaPtr &left,
-                                                 const CltlFormulaPtr &right,
-                                                 Instantiator *instantiator) const;
+                                                 const CltlFormulaPtr &right);
 
     virtual void _preprocess(const CltlFormulaPtr &formula, unsigned int n) const override;
 };
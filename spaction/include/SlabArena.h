@@ -0,0 +1,107 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_SLABARENA_H_
+#define SPACTION_INCLUDE_SLABARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace spaction {
+
+/// A bump allocator that carves memory out of large slabs.
+/// @remarks
+///     Memory is never given back individually: every slab is released at once when the arena
+///     is destroyed. Objects living in the arena must therefore be destroyed explicitly (if they
+///     have a non-trivial destructor) before their arena goes away.
+class SlabArena {
+ public:
+    explicit SlabArena(std::size_t slab_size = 64 * 1024)
+    : _slab_size(slab_size), _current(nullptr), _offset(0) { }
+
+    ~SlabArena() {
+        for (auto slab : _slabs) {
+            ::operator delete(slab);
+        }
+    }
+
+    /// Copy construction is forbidden.
+    SlabArena(const SlabArena &) = delete;
+    /// Copy assignment is forbidden.
+    SlabArena &operator=(const SlabArena &) = delete;
+
+    /// Returns `size` bytes of memory aligned on `alignment`, which must be a power of 2.
+    void *allocate(std::size_t size, std::size_t alignment) {
+        std::size_t offset = (_offset + alignment - 1) & ~(alignment - 1);
+
+        if ((_current == nullptr) or (offset + size > _slab_size)) {
+            // requests that would waste most of a slab get a block of their own
+            if (size > _slab_size / 4) {
+                _slabs.push_back(static_cast<char*>(::operator new(size)));
+                return _slabs.back();
+            }
+
+            _current = static_cast<char*>(::operator new(_slab_size));
+            _slabs.push_back(_current);
+            offset = 0;
+        }
+
+        _offset = offset + size;
+        return _current + offset;
+    }
+
+ private:
+    const std::size_t _slab_size;
+    std::vector<char*> _slabs;
+    char *_current;
+    std::size_t _offset;
+};
+
+/// A standard allocator drawing its memory from a SlabArena.
+/// @remarks
+///     Deallocation is a no-op, memory being reclaimed along with the arena.
+template<typename T>
+class ArenaAllocator {
+ public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(SlabArena &arena) : _arena(&arena) { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : _arena(other.arena()) { }
+
+    T *allocate(std::size_t n) {
+        return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, std::size_t) { }
+
+    SlabArena *arena() const { return _arena; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &rhs) const { return _arena == rhs.arena(); }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U> &rhs) const { return _arena != rhs.arena(); }
+
+ private:
+    SlabArena *_arena;
+};
+
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_SLABARENA_H_
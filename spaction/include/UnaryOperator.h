@@ -46,17 +46,13 @@ class UnaryOperator : public CltlFormula {
     /// Returns a equivalent formula in negation normal form.
     virtual CltlFormulaPtr to_nnf();
 
+    /// Returns a equivalent formula in disjunctive normal form.
+    virtual CltlFormulaPtr to_dnf();
+
     inline const CltlFormulaPtr &operand() const { return _operand; }
 
     void accept(CltlFormulaVisitor &visitor) override;
 
-    inline std::size_t height() const { return 1 + _operand->height(); }
-
-    bool is_infltl() const;
-    bool is_supltl() const;
-    bool is_propositional() const;
-    bool is_nnf() const;
-
     std::string dump() const override;
 
  protected:
@@ -69,6 +65,12 @@ class UnaryOperator : public CltlFormula {
 
     UnaryOperatorType _type;
     const CltlFormulaPtr _operand;
+
+    /// Computes the structural hash of a unary operation, without building it.
+    static std::size_t _make_hash(UnaryOperatorType type, const CltlFormulaPtr &operand);
+    /// Returns whether or not `formula` is the unary operation `type` applied to `operand`.
+    static bool _is_same(const CltlFormula &formula, UnaryOperatorType type,
+                         const CltlFormulaPtr &operand);
 };
 
 }  // namespace spaction
@@ -0,0 +1,388 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_BOUNDEDCOUNTERAUTOMATON_H_
+#define SPACTION_INCLUDE_AUTOMATA_BOUNDEDCOUNTERAUTOMATON_H_
+
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+#include "automata/ConfigurationAutomaton.h"
+#include "hash/hash.h"
+
+namespace spaction {
+namespace automata {
+
+/// a class to represent a configuration of a CA whose counters are capped at some bound n
+/// i.e. a pair <s,c> where
+///     * s is a state of the automaton
+///     * c is a vector indicating the current value of each counter, up to n
+///
+/// Comp is a comparator operator for states (see MinMaxConfiguration).
+template<typename Q, typename Comp=mycompare<Q>>
+class BoundedConfiguration {
+ public:
+    explicit BoundedConfiguration(const Q &q, std::size_t nb_counters)
+    : BoundedConfiguration(q, std::vector<unsigned int>(nb_counters, 0))
+    {}
+
+    explicit BoundedConfiguration(const Q &q, const std::vector<unsigned int> &values)
+    : _state(q)
+    , _counter_values(values)
+    {}
+
+    ~BoundedConfiguration() {}
+
+    /// getters
+    const Q &state() const { return _state; }
+    const std::vector<unsigned int> &values() const { return _counter_values; }
+
+    /// usual comparison operators
+    bool operator==(const BoundedConfiguration &other) const {
+        return Comp()(_state, other._state) == 0 and _counter_values == other._counter_values;
+    }
+
+    bool operator<(const BoundedConfiguration &other) const {
+        int state_comp = Comp()(_state, other._state);
+        if (state_comp == 0)
+            return _counter_values < other._counter_values;
+        return state_comp < 0;
+    }
+
+ private:
+    // the state of the automaton
+    const Q _state;
+    // the current values of the counters, all lower or equal to the bound
+    std::vector<unsigned int> _counter_values;
+};
+
+/// a class to represent the TS of a bounded-counter automaton
+/// @remarks
+///     The counters of the underlying TS are capped at `bound`, and a transition that checks a
+///     counter whose value is lower than `bound` is dropped. The runs that remain are thus exactly
+///     those of value at least `bound` in the underlying counter automaton, and the counters can
+///     be forgotten: the labels of this TS keep the letter and the acceptance conditions only.
+///     This TS has at most |TS|.(bound+1)^k states, k being the number of counters.
+template<typename Q, typename S, template<typename, typename> class TS>
+class BoundedCounterTS : public TransitionSystem<BoundedConfiguration<Q>, S> {
+ public:
+    // helper typedef for base
+    using super_type = TransitionSystem<BoundedConfiguration<Q>, S>;
+
+    // @todo clean this up (restrict visibility?)
+    explicit BoundedCounterTS(): BoundedCounterTS(nullptr, 0, 0) {}
+
+    explicit BoundedCounterTS(TS<Q, S> *ts, std::size_t nb_counters, unsigned int bound)
+    : super_type(new RefControlBlock<Transition<BoundedConfiguration<Q>, S>>(
+            std::bind(&BoundedCounterTS::_delete_transition, this, std::placeholders::_1)))
+    , _transition_system(ts)
+    , _nb_counters(nb_counters)
+    , _bound(bound)
+    {}
+
+    /// from s, return (s, 0 \dots 0)
+    /// useful to define the initial configuration from the initial state
+    BoundedConfiguration<Q> default_config(const Q &state) const {
+        return BoundedConfiguration<Q>(state, _nb_counters);
+    }
+
+    /// the bound at which counters are capped
+    unsigned int bound() const { return _bound; }
+
+    virtual void add_state(const BoundedConfiguration<Q> &state) override {
+        _transition_system->add_state(state.state());
+    }
+    /// @note   several configurations may refer to the same state q, so q is not removed from the
+    ///         underlying TS (see MinMaxConfigTS).
+    virtual void remove_state(const BoundedConfiguration<Q> &state) override {}
+    virtual bool has_state(const BoundedConfiguration<Q> &state) const override {
+        return _transition_system->has_state(state.state());
+    }
+
+    virtual const Transition<BoundedConfiguration<Q>, S> *add_transition(const BoundedConfiguration<Q> &source, const BoundedConfiguration<Q> &sink, const S &label) override {
+        return super_type::_make_transition(source, sink, label);
+    }
+    virtual void remove_transition(const BoundedConfiguration<Q> &source, const BoundedConfiguration<Q> &sink, const S &label) override {}
+
+    virtual void print_state(std::ostream &os, const BoundedConfiguration<Q> &q) const override {
+        os << "(";
+        _transition_system->print_state(os, q.state());
+        os << ", [";
+        for (auto &v : q.values())
+            os << "," << v;
+        os << "])";
+    }
+
+    virtual void print_label(std::ostream &os, const S &s) const override {
+        _transition_system->print_label(os, s);
+    }
+
+ private:
+    TS<Q,S> *_transition_system;
+    // the number of counters
+    std::size_t _nb_counters;
+    // the value at which counters are capped
+    unsigned int _bound;
+
+    /// Applies the counter operations of `label` to the counters `values`.
+    /// Operations are applied in the same order as in MinMaxConfigTS.
+    /// @return false iff a counter lower than the bound is checked
+    bool _apply(const S &label, std::vector<unsigned int> &values) const {
+        auto &ops = label.get_operations();
+        for (std::size_t k = 0; k != ops.size(); ++k) {
+            const CounterOperation op = ops[k];
+            if (op & kIncrement) {
+                values[k] = std::min(values[k] + 1, _bound);
+            }
+            if (op & kCheck) {
+                if (values[k] < _bound)
+                    return false;
+            }
+            if (op & kReset) {
+                values[k] = 0;
+            }
+        }
+        return true;
+    }
+
+    /// the label of this TS that corresponds to `label` in the underlying TS
+    static S _counterless(const S &label) {
+        return S(label.letter(), CounterOperations(), label.get_acceptance());
+    }
+
+    class TransitionBaseIterator : public super_type::TransitionBaseIterator {
+     public:
+        explicit TransitionBaseIterator(BoundedCounterTS *ts, const BoundedConfiguration<Q> &s, const S *label, typename TS<Q,S>::TransitionIterator it, typename TS<Q,S>::TransitionIterator end)
+        : _ts(ts)
+        , _source(s)
+        , _label(label)
+        , _iterator(it)
+        , _end(end)
+        {
+            _skip_dropped();
+        }
+        ~TransitionBaseIterator() {}
+
+        bool is_equal(const typename super_type::TransitionBaseIterator& rhs) const override {
+            const TransitionBaseIterator *rr = static_cast<const TransitionBaseIterator *>(&rhs);
+            return _source == rr->_source && !(_iterator != rr->_iterator);
+        }
+
+        typename super_type::TransitionBaseIterator *clone() const override {
+            return new TransitionBaseIterator(*this);
+        }
+
+        TransitionPtr<BoundedConfiguration<Q>, S> operator*() override {
+            // the sink values have already been computed by `_skip_dropped`
+            auto res = _ts->add_transition(_source,
+                                           BoundedConfiguration<Q>((*_iterator)->sink(), _values),
+                                           _counterless((*_iterator)->label()));
+            return TransitionPtr<BoundedConfiguration<Q>, S>(res, _ts->get_control_block());
+        }
+
+        const typename super_type::TransitionBaseIterator& operator++() override {
+            ++_iterator;
+            _skip_dropped();
+            return *this;
+        }
+
+     private:
+        BoundedCounterTS *_ts;
+        const BoundedConfiguration<Q> _source;
+        // if not null, only the transitions with this label are iterated over
+        const S *_label;
+        typename TS<Q,S>::TransitionIterator _iterator;
+        typename TS<Q,S>::TransitionIterator _end;
+        // the counter values reached by the current transition
+        std::vector<unsigned int> _values;
+
+        /// moves to the next transition that is not dropped, if any
+        void _skip_dropped() {
+            for (; _iterator != _end; ++_iterator) {
+                const S &label = (*_iterator)->label();
+                if (_label and !(_counterless(label) == *_label))
+                    continue;
+                _values = _source.values();
+                if (_ts->_apply(label, _values))
+                    return;
+            }
+        }
+    };
+
+    /// @note   makes a DFS of the configuration TS, from the zero-valued configurations of every
+    ///         state of the underlying TS. As counters are bounded, the exploration terminates.
+    class StateBaseIterator : public super_type::StateBaseIterator {
+     public:
+        explicit StateBaseIterator(BoundedCounterTS *ts, bool is_end=false)
+        : _ts(ts)
+        , _is_end(is_end)
+        , _current(0)
+        {
+            if (_is_end)
+                return;
+
+            std::unordered_set<BoundedConfiguration<Q>> seen;
+            std::deque<BoundedConfiguration<Q>> todo;
+            for (auto q : _ts->_transition_system->states()) {
+                auto c = _ts->default_config(q);
+                if (seen.insert(c).second)
+                    todo.push_back(c);
+            }
+            while (!todo.empty()) {
+                auto c = todo.back();
+                todo.pop_back();
+                auto wrapper = (*_ts)(c);
+                for (auto t : wrapper.successors()) {
+                    if (seen.insert(t->sink()).second)
+                        todo.push_back(t->sink());
+                }
+            }
+            _states = std::vector<BoundedConfiguration<Q>>(seen.begin(), seen.end());
+        }
+        virtual ~StateBaseIterator() { }
+
+        virtual bool is_equal(const typename super_type::StateBaseIterator& rhs) const override {
+            const StateBaseIterator *rr = static_cast<const StateBaseIterator *>(&rhs);
+            if (_ts != rr->_ts)
+                return false;
+            if (_at_end() or rr->_at_end())
+                return _at_end() == rr->_at_end();
+            return _current == rr->_current;
+        }
+        virtual typename super_type::StateBaseIterator *clone() const override {
+            return new StateBaseIterator(*this);
+        }
+
+        virtual BoundedConfiguration<Q> operator*() override {
+            assert(!_at_end());
+            return _states[_current];
+        }
+        virtual const typename super_type::StateBaseIterator& operator++() override {
+            assert(!_at_end());
+            ++_current;
+            return *this;
+        }
+
+     private:
+        BoundedCounterTS *_ts;
+        bool _is_end;
+
+        std::vector<BoundedConfiguration<Q>> _states;
+        std::size_t _current;
+
+        bool _at_end() const { return _is_end or _current == _states.size(); }
+    };
+
+    virtual typename super_type::TransitionBaseIterator *
+    _successor_begin(const BoundedConfiguration<Q> &state, const S *label) override {
+        // labels differ from those of the underlying TS, so filtering is done by the iterator
+        auto wrapper = (*_transition_system)(state.state());
+        return new TransitionBaseIterator(this, state, label, wrapper.successors().begin(), wrapper.successors().end());
+    }
+    virtual typename super_type::TransitionBaseIterator *
+    _successor_end(const BoundedConfiguration<Q> &state) override {
+        auto wrapper = (*_transition_system)(state.state());
+        return new TransitionBaseIterator(this, state, nullptr, wrapper.successors().end(), wrapper.successors().end());
+    }
+
+    /// @note deliberately left unimplemented
+    virtual typename super_type::TransitionBaseIterator *
+    _predecessor_begin(const BoundedConfiguration<Q> &state, const S *label) override {
+        assert(false);
+        return nullptr;
+    }
+    /// @note deliberately left unimplemented
+    virtual typename super_type::TransitionBaseIterator *
+    _predecessor_end(const BoundedConfiguration<Q> &state) override {
+        assert(false);
+        return nullptr;
+    }
+
+    virtual typename super_type::StateBaseIterator *_state_begin() override {
+        return new StateBaseIterator(this);
+    }
+    virtual typename super_type::StateBaseIterator *_state_end() override {
+        return new StateBaseIterator(this, true);
+    }
+};
+
+template<typename Q, typename S, template<typename, typename> class TS>
+struct _BoundedCounterTS {};
+
+template<typename Q, typename S, template<typename, typename> class TS>
+struct _BoundedCounterTS<BoundedConfiguration<Q>, S, TS> {
+    using type = BoundedCounterTS<Q,S,TS>;
+};
+
+/// A template typedef to reorder the template arguments
+template<template<typename, typename> class TS>
+struct BoundedCounterConfigurationTS {
+    template<typename Q, typename S>
+    using type = typename _BoundedCounterTS<Q,S,TS>::type;
+};
+
+/// Make a bounded-counter automaton from a counter automaton, as a counterless counter automaton.
+/// It accepts the words of value at least `bound` in a sup-automaton (see MinMaxConfiguration), so
+/// it can be used in place of the automaton of an instantiated formula (see InstantiateSup), and
+/// it only needs to be built once for the translation of the cost formula.
+/// Use CA2tgba to see it as a tgba
+template<typename Q, typename S, template<typename, typename> class TransitionSystemType>
+class BoundedCounterAutomaton : public CounterAutomaton<BoundedConfiguration<Q>, S, BoundedCounterConfigurationTS<TransitionSystemType>::template type> {
+ public:
+    // useful typedef for the super type
+    using super_type = CounterAutomaton<BoundedConfiguration<Q>, S, BoundedCounterConfigurationTS<TransitionSystemType>::template type>;
+    /// constructor
+    explicit BoundedCounterAutomaton(const CounterAutomaton<Q, S, TransitionSystemType> &ca, unsigned int bound)
+    : super_type(0, ca.num_acceptance_sets())
+    {
+        BoundedCounterTS<Q, CounterLabel<S>, TransitionSystemType> * tmp =
+            new BoundedCounterTS<Q, CounterLabel<S>, TransitionSystemType>(ca.transition_system(), ca.num_counters(), bound);
+        delete super_type::_transition_system;
+        super_type::_transition_system = tmp;
+        super_type::set_initial_state(tmp->default_config(*ca.initial_state()));
+    }
+};
+
+// factory function
+template<typename Q, typename S, template<typename, typename> class TS>
+BoundedCounterAutomaton<Q,S,TS>
+make_bounded_counter_automaton(const CounterAutomaton<Q, S, TS> &a, unsigned int bound) {
+    return BoundedCounterAutomaton<Q,S,TS>(a, bound);
+}
+
+}  // namespace automata
+}  // namespace spaction
+
+namespace std {
+
+template<typename Q>
+struct hash<spaction::automata::BoundedConfiguration<Q>> {
+    typedef spaction::automata::BoundedConfiguration<Q> argument_type;
+    typedef std::size_t result_type;
+
+    result_type operator()(const argument_type &c) const {
+        std::size_t res = hash<Q>()(c.state());
+        res = spaction::hash_range(res, c.values().begin(), c.values().end());
+        return spaction::hash_mix(res);
+    }
+};
+
+}  // namespace std
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_BOUNDEDCOUNTERAUTOMATON_H_
@@ -274,8 +274,9 @@ class CA2tgba : public spot::tgba {
         prod.print(spaction::Logger<std::cerr>::instance().debug());
         ///@}
 
-        auto config_prod = make_minmax_configuration_automaton(prod);
-        auto sup_finder = make_sup_comput(config_prod);
+        auto config_view = make_minmax_view(prod);
+        auto sup_finder = make_sup_comput(config_view, config_view.default_config(*prod.initial_state()),
+                                          prod.num_acceptance_sets());
         auto value = sup_finder.find_supremum(upper_bound);
         delete lasso;
 
@@ -22,12 +22,16 @@
 #include <set>
 #include <stack>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "CltlFormula.h"
 #include "automata/CounterAutomaton.h"
+#include "automata/LazyTransitionSystem.h"
 #include "automata/TransitionSystemPrinter.h"
 #include "automata/UndeterministicTransitionSystem.h"
+#include "bitset/DynamicBitset.h"
 #include "hash/hash.h"
 
 namespace spaction {
@@ -50,6 +54,10 @@ class CltlTranslator {
     ~CltlTranslator() { }
 
     void build_automaton();
+    /// Sets the automaton up to be built on the fly, as its states get explored (see
+    /// LazyTransitionSystem), rather than all at once as by `build_automaton`.
+    /// @note   the translator must outlive the exploration of the automaton
+    void build_lazy_automaton();
 
     void automaton_dot(const std::string &dotfile) {
         _automaton.print(dotfile);
@@ -59,6 +67,39 @@ class CltlTranslator {
         p.dump(dotfile);
     }
 
+    /// Index of the closure of the translated formula, over which the terms of the nodes are encoded.
+    ///
+    /// The closure contains the subformulae of the translated formula, and the formulae X(f) for
+    /// each of its (cost) Until and Release subformulae f, ie. every formula that might appear in a
+    /// node. Each of them is given an index, following the order of `get_formula_order`.
+    struct Closure {
+        /// the formulae of the closure, sorted according to `get_formula_order`
+        FormulaList formulae;
+        /// the index of each formula of the closure
+        std::unordered_map<const CltlFormula*, std::size_t> index;
+
+        /// the binary operators of the closure
+        DynamicBitset binary_operators;
+        /// the false constants of the closure
+        DynamicBitset false_constants;
+        /// the negations of the closure
+        DynamicBitset negations;
+        /// for each negation, the index of its operand (DynamicBitset::npos for the other formulae)
+        std::vector<std::size_t> negated_operand;
+        /// for each X formula, the index of its operand (DynamicBitset::npos for the other formulae)
+        std::vector<std::size_t> next_operand;
+        /// for each formula f whose X(f) is in the closure, the index of X(f) (DynamicBitset::npos
+        /// for the other formulae)
+        /// @remarks    the translation thus never builds formulae, and does not lock the factory
+        std::vector<std::size_t> next_formula;
+
+        /// computes the closure of `formula`
+        void build(const CltlFormulaPtr &formula);
+
+        /// encodes a list of formulae of the closure
+        DynamicBitset make(const FormulaList &terms) const;
+    };
+
     /// Helper class representing the states of the temporary transition system.
     ///
     /// This struct is used to represent states and pseudo-states of the the temporary transition
@@ -66,13 +107,16 @@ class CltlTranslator {
     /// pseudo-states are those obtained by building the epsilon-transitions from actual states.
     class Node {
      public:
-        /// `terms` is assumed to be sorted according to `_unique_sort` (see below)
-        /// this constructor is therefore not supposed to be called outside of `_build_node`
-        explicit inline Node(const CltlTranslator::FormulaList &terms) :
-            _terms(terms), _is_processed(false) {
+        /// `terms` is a subset of `closure`, that must outlive the node
+        /// this constructor is not supposed to be called outside of `_build_node`
+        explicit inline Node(const DynamicBitset &terms, const Closure *closure) :
+            _terms(terms), _closure(closure), _is_processed(false) {
         }
 
-        const inline CltlTranslator::FormulaList &terms() const { return _terms; }
+        /// the subformulae of this node, ordered by height
+        CltlTranslator::FormulaList terms() const;
+        /// the subformulae of this node, as a subset of the closure
+        const inline DynamicBitset &bits() const { return _terms; }
 
         void inline set_processed(bool processed = true) { _is_processed = processed; }
         bool inline is_processed() const { return _is_processed; }
@@ -86,11 +130,12 @@ class CltlTranslator {
         const std::string dump(const std::string &sep=",") const;
 
      private:
-        /// List of subformulae corresponding to this pseudo-state.
+        /// Set of subformulae corresponding to this pseudo-state.
         /// @remarks
-        ///     This list remains always ordered by the height of the formulae it contains, such
-        ///     that the latest element of the list is the biggest formula.
-        const CltlTranslator::FormulaList _terms;
+        ///     The closure being ordered by the height of the formulae, the highest bit set is
+        ///     (one of) the biggest formula.
+        const DynamicBitset _terms;
+        const Closure *_closure;
 
         bool _is_processed;
     };
@@ -122,6 +167,10 @@ class CltlTranslator {
     typedef CounterAutomaton<Node*, FormulaList, UndeterministicTransitionSystem> automaton_type;
     inline automaton_type & get_automaton() { return _automaton; }
 
+    /// the type of the automaton built on the fly
+    typedef CounterAutomaton<Node*, FormulaList, LazyTransitionSystem> lazy_automaton_type;
+    inline lazy_automaton_type & get_lazy_automaton() { return _lazy_automaton; }
+
     static std::function<bool (const CltlFormulaPtr &, const CltlFormulaPtr &)> get_formula_order();
 
  private:
@@ -132,15 +181,21 @@ class CltlTranslator {
 
     /// Stores the formula being translated by this translator.
     const CltlFormulaPtr _formula;
+    /// Stores the closure of `_formula`, over which the nodes are encoded.
+    Closure _closure;
 
     /// Stores the set of pseudo-states built during the construction of the transition system, to
     /// ensure their uniqueness.
     NodeList _nodes;
+    /// Indexes the nodes of `_nodes` by their terms, for `_build_node` lookups.
+    std::unordered_map<DynamicBitset, Node*> _nodes_index;
 
     /// Stores the temporar transition system that is used to build the automata.
     UndeterministicTransitionSystem<Node*, TransitionLabel*> _transition_system;
     /// Stores the actual automaton
     automaton_type _automaton;
+    /// Stores the automaton built on the fly
+    lazy_automaton_type _lazy_automaton;
 
     std::size_t _nb_acceptances;
     /// Associates each Until sub-formula to an acceptance condition
@@ -152,11 +207,35 @@ class CltlTranslator {
     /// for the intermediate automaton construction
     std::stack<Node*> _to_be_reduced;
     std::stack<Node*> _to_be_fired;
-    std::vector<Node*> _states;
+    std::unordered_set<Node*> _states;
+
+    /// Summary of the epsilon-paths from a pseudo-state to a reduced one.
+    ///
+    /// Along an epsilon-path, only the actions on the counters and the postponed formulae matter:
+    /// paths to the same reduced node that agree on both are equivalent for the epsilon-removal.
+    struct EpsilonSummary {
+        /// the reduced node reached
+        Node *target;
+        /// the actions on the counters along the path
+        CounterOperationList counter_actions;
+        /// the acceptance conditions of the formulae postponed along the path
+        std::set<std::size_t> postponed;
+
+        explicit inline EpsilonSummary(Node *target, std::size_t nb_counters) :
+            target(target), counter_actions(nb_counters) {
+        }
+
+        inline bool operator==(const EpsilonSummary &other) const {
+            return target == other.target and counter_actions == other.counter_actions
+                and postponed == other.postponed;
+        }
+    };
 
     /// for the epsilon-removal
     std::stack<Node*> _to_remove_epsilon;
     std::set<Node*> _done_remove_epsilon;
+    /// the epsilon-closures computed so far, ie. the summaries of the epsilon-paths from each node
+    std::unordered_map<Node*, std::vector<EpsilonSummary>> _epsilon_closures;
 
     /// Helper functions for counter actions
     // for B automata (LTL[<=])
@@ -168,12 +247,8 @@ class CltlTranslator {
     // the no-op action
     inline static CounterOperation _e()     { return static_cast<CounterOperation>(0); }
 
-    /// a helper function that returns from a list of terms a sorted set, to ease comparison.
-    /// Sorting is done according to height, so that the last element of the list
-    /// is also (one of) the highest.
-    static FormulaList _unique_sort(const CltlTranslator::FormulaList &terms);
     /// Either builds or returns an existing node for the given set of `terms`.
-    Node *_build_node(const FormulaList &terms);
+    Node *_build_node(const DynamicBitset &terms);
 
     /// Builds the epsilon successors of the given `node` and updates the transition system
     /// accordingly.
@@ -187,16 +262,28 @@ class CltlTranslator {
     void _build_transition_system();
     void _process_reduce();
     void _process_fire();
+    /// Builds the successors of `node` in the temporary transition system, unless it was already
+    /// done (as `_process_reduce` and `_process_fire` would).
+    void _build_successors(Node *node);
+    /// Calls `f` on each transition of the temporary transition system from `node`.
+    template<typename F> void _for_each_successor(Node *node, F f);
     /// Builds the actual automaton by removing epsilon-transitions
     void _build_automaton();
     void _process_remove_epsilon();
-    void _process_remove_epsilon(Node *source, Node *s, const std::vector<TransitionLabel*> &trace);
-    void _add_nonepsilon_transition(Node *source, Node *sink,
-                                    const std::vector<TransitionLabel*> &trace);
-
-    /// Helper method that inserts a formula into a FormulaList and keeps the result sorted.
-    FormulaList _insert(const FormulaList &list,
-                        const std::initializer_list<CltlFormulaPtr> &add_list) const;
+    /// Adds to `ts` the transitions from `source` in the automaton without epsilon-transitions.
+    /// @return the sinks of the transitions added
+    NodeList _remove_epsilon(Node *source, automaton_type::transition_system_t *ts);
+    /// Returns the epsilon-closure of `node`, computing (and memoizing) it if needed.
+    const std::vector<EpsilonSummary> &_epsilon_closure(Node *node);
+    /// Appends a transition of the temporary transition system to an epsilon-path summary.
+    void _append_to_summary(EpsilonSummary &summary, const TransitionLabel *label) const;
+    void _add_nonepsilon_transition(automaton_type::transition_system_t *ts, Node *source,
+                                    Node *sink, const EpsilonSummary &summary,
+                                    const TransitionLabel *label);
+
+    /// Helper method that inserts formulae of the closure into a set of terms.
+    DynamicBitset _insert(const DynamicBitset &terms,
+                          const std::initializer_list<CltlFormulaPtr> &add_list) const;
 };
 
 }  // namespace automata
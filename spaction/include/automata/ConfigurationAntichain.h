@@ -0,0 +1,121 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_CONFIGURATIONANTICHAIN_H_
+#define SPACTION_INCLUDE_AUTOMATA_CONFIGURATIONANTICHAIN_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace spaction {
+namespace automata {
+
+/// A set of configurations interned in a ConfigurationStore, that only keeps the maximal ones for
+/// the domination order.
+/// @remarks
+///     Only the ids of the configurations are kept, and compared through their packed records
+///     (see ConfigurationStore::dominates), so that the configurations are not stored twice. The
+///     antichain owns a reference on each of them, and releases the ones it drops, so that the
+///     store frees the dominated configurations.
+///     Configurations are bucketed by the id of their state, since only configurations on the
+///     same state may dominate each other. The buckets are sharded by state, each shard behind
+///     its own mutex, so that several searches may share the antichain of their dead
+///     configurations (see ParallelSupremumFinder).
+template<typename Store>
+class ConfigurationAntichain {
+    enum : std::size_t {
+        kShardBits = 6,
+        kShards = std::size_t(1) << kShardBits,
+        kShardMask = kShards - 1
+    };
+
+ public:
+    typedef typename Store::id_type id_type;
+    typedef typename Store::config_type config_type;
+
+    explicit ConfigurationAntichain(Store &store) : _store(&store), _size(0) {}
+
+    ConfigurationAntichain(const ConfigurationAntichain &) = delete;
+    ConfigurationAntichain &operator=(const ConfigurationAntichain &) = delete;
+
+    /// returns true iff a configuration of the antichain dominates `config`
+    bool covers(const config_type &config) const {
+        typename Store::RecordBuffer record(_store->record_words());
+        // no configuration on a state that has never been interned is in the antichain
+        if (!_store->pack(config, record.data()))
+            return false;
+        id_type state = Store::state_of(record.data());
+        const Shard &shard = _shards[state & kShardMask];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.buckets.find(state);
+        if (it == shard.buckets.end())
+            return false;
+        const std::uint32_t *packed = record.data();
+        return std::any_of(it->second.begin(), it->second.end(),
+                           [this, packed](id_type c) { return _store->dominates(c, packed); });
+    }
+
+    /// Adds the configuration interned as `id`, and removes the configurations it dominates.
+    /// @param  id  a configuration whose reference is handed over to the antichain
+    /// @return false iff it was already covered, in which case it is released instead
+    bool insert(id_type id) {
+        const std::uint32_t *record = _store->record(id);
+        id_type state = Store::state_of(record);
+        Shard &shard = _shards[state & kShardMask];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto &bucket = shard.buckets[state];
+        for (id_type c : bucket) {
+            if (_store->dominates(c, record)) {
+                _store->release(id);
+                return false;
+            }
+        }
+        // unlike remove_if, partition keeps the dominated configurations, to be released
+        auto last = std::partition(bucket.begin(), bucket.end(), [this, id](id_type c) {
+            return !_store->dominates(id, _store->record(c));
+        });
+        _size -= bucket.end() - last;
+        for (auto it = last; it != bucket.end(); ++it)
+            _store->release(*it);
+        bucket.erase(last, bucket.end());
+        bucket.push_back(id);
+        ++_size;
+        return true;
+    }
+
+    /// the number of configurations in the antichain
+    std::size_t size() const { return _size.load(std::memory_order_relaxed); }
+
+ private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<id_type, std::vector<id_type>> buckets;
+    };
+
+    Store *_store;
+    Shard _shards[kShards];
+    std::atomic<std::size_t> _size;
+};
+
+}  // namespace automata
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_CONFIGURATIONANTICHAIN_H_
@@ -18,6 +18,13 @@
 #ifndef SPACTION_INCLUDE_AUTOMATA_CONFIGURATIONAUTOMATON_H_
 #define SPACTION_INCLUDE_AUTOMATA_CONFIGURATIONAUTOMATON_H_
 
+#include <cstdint>
+#include <limits>
+
+#include "automata/TransitionSystemView.h"
+#include "bitset/DynamicBitset.h"
+#include "hash/hash.h"
+
 namespace spaction {
 namespace automata {
 
@@ -29,7 +36,7 @@ namespace automata {
 template<typename Q>
 struct mycompare {
     int operator()(const Q &lhs, const Q &rhs) const {
-        if (std::equal_to<Q>(lhs, rhs))
+        if (std::equal_to<Q>()(lhs, rhs))
             return 0;
         if (std::less<Q>()(lhs, rhs))
             return -1;
@@ -52,14 +59,11 @@ template<typename A>
 struct mycompare<std::pair<CltlTranslator::Node *, A>> {
     using pair_type = std::pair<CltlTranslator::Node *, A>;
     int operator()(const pair_type &lhs, const pair_type &rhs) const {
-        if (lhs.first->terms() == rhs.first->terms()) {
+        int first_comp = lhs.first->bits().compare(rhs.first->bits());
+        if (first_comp == 0) {
             return mycompare<A>()(lhs.second, rhs.second);
-        } else {
-            if (lhs.first->terms() < rhs.first->terms())
-                return -1;
-            else
-                return 1;
         }
+        return first_comp;
     }
 };
 
@@ -83,6 +87,109 @@ typedef struct {
     unsigned int value;
 } value_t;
 
+/// The values of the counters of a configuration.
+/// @remarks
+///     Counters saturate at `max_value`: past the bound of a supremum search, the exact value of a
+///     counter does not matter any more, but a value past the bound is then reported as
+///     `max_value`, not as the exact one. The values are packed on the least number of bits that
+///     fits `max_value`, so that the counters of a configuration usually fit inline.
+class CounterValues {
+ public:
+    explicit CounterValues(std::size_t counters,
+                           unsigned int max_value = std::numeric_limits<unsigned int>::max())
+    : _max_value(max_value)
+    , _width(_width_for(max_value))
+    , _bits(_width * counters) {}
+
+    inline std::size_t size() const { return _bits.size() / _width; }
+    inline unsigned int max_value() const { return _max_value; }
+
+    inline unsigned int operator[](std::size_t counter) const {
+        return static_cast<unsigned int>(_bits.get(_width * counter, _width));
+    }
+
+    /// Increments `counter`, unless it is saturated.
+    inline void increment(std::size_t counter) {
+        unsigned int value = (*this)[counter];
+        if (value < _max_value)
+            _bits.put(_width * counter, _width, value + 1);
+    }
+    inline void reset(std::size_t counter) { _bits.put(_width * counter, _width, 0); }
+
+    inline bool operator==(const CounterValues &other) const { return _bits == other._bits; }
+    inline bool operator!=(const CounterValues &other) const { return _bits != other._bits; }
+    /// lexicographic order
+    bool operator<(const CounterValues &other) const {
+        assert(size() == other.size());
+        for (std::size_t k = 0; k != size(); ++k) {
+            if ((*this)[k] != other[k])
+                return (*this)[k] < other[k];
+        }
+        return false;
+    }
+
+    inline std::size_t hash() const { return _bits.hash(); }
+
+    /// the number of 32-bit words of the packed values (see pack)
+    inline std::size_t num_words() const { return (_bits.size() + kWordBits - 1) / kWordBits; }
+
+    /// Writes the packed values to `words`.
+    void pack(std::uint32_t *words) const {
+        for (std::size_t pos = 0, w = 0; pos < _bits.size(); pos += kWordBits, ++w)
+            words[w] = static_cast<std::uint32_t>(_bits.get(pos, _chunk(pos)));
+    }
+
+    /// returns true iff each of the values packed in `words` is at least the one packed in
+    /// `other` (see pack)
+    static bool packed_dominates(const std::uint32_t *words, const std::uint32_t *other,
+                                 std::size_t counters, unsigned int max_value) {
+        unsigned int width = _width_for(max_value);
+        for (std::size_t k = 0; k != counters; ++k) {
+            if (_packed_value(words, width * k, width) < _packed_value(other, width * k, width))
+                return false;
+        }
+        return true;
+    }
+
+    /// the values packed in `words` (see pack)
+    static CounterValues unpack(const std::uint32_t *words, std::size_t counters,
+                                unsigned int max_value) {
+        CounterValues result(counters, max_value);
+        for (std::size_t pos = 0, w = 0; pos < result._bits.size(); pos += kWordBits, ++w)
+            result._bits.put(pos, result._chunk(pos), words[w]);
+        return result;
+    }
+
+ private:
+    enum : std::size_t { kWordBits = 32 };
+
+    unsigned int _max_value;
+    unsigned int _width;
+    DynamicBitset _bits;
+
+    /// the number of bits of the packed word starting at `pos`
+    inline std::size_t _chunk(std::size_t pos) const {
+        return std::min<std::size_t>(kWordBits, _bits.size() - pos);
+    }
+
+    /// the value packed on the `width` bits of `words` from `pos`
+    static std::uint64_t _packed_value(const std::uint32_t *words, std::size_t pos,
+                                       unsigned int width) {
+        std::size_t w = pos / kWordBits, b = pos % kWordBits;
+        std::uint64_t result = words[w] >> b;
+        if (b + width > kWordBits)
+            result |= std::uint64_t(words[w + 1]) << (kWordBits - b);
+        return result & ((std::uint64_t(1) << width) - 1);
+    }
+
+    static unsigned int _width_for(unsigned int max_value) {
+        unsigned int result = 1;
+        while (result < std::numeric_limits<unsigned int>::digits and (max_value >> result) != 0)
+            ++result;
+        return result;
+    }
+};
+
 /// a class to represent a configuration of a CA
 /// i.e. a tuple <s,v,c> where
 ///     * s is a state of the automaton
@@ -97,16 +204,19 @@ typedef struct {
 template<typename Q, typename Comp=mycompare<Q>>
 class MinMaxConfiguration {
  public:
-    explicit MinMaxConfiguration(const Q &q, std::size_t nb_counters)
-    : MinMaxConfiguration(q, false, 0, std::vector<unsigned int>(nb_counters, 0))
+    /// @param  max_value   the value at which counters saturate (see CounterValues)
+    explicit MinMaxConfiguration(const Q &q, std::size_t nb_counters,
+                                 unsigned int max_value = std::numeric_limits<unsigned int>::max())
+    : MinMaxConfiguration(q, false, 0, CounterValues(nb_counters, max_value))
     {
         assert(nb_counters > 0);
     }
 
-    explicit MinMaxConfiguration(const Q &q, bool is_bounded, unsigned int value, const std::vector<unsigned int> &values)
+    explicit MinMaxConfiguration(const Q &q, bool is_bounded, unsigned int value, const CounterValues &values)
     : _state(q)
     , _value({!is_bounded, value})
     , _counter_values(values)
+    , _hash(_compute_hash())
     {
         assert(_counter_values.size() > 0);
     }
@@ -117,12 +227,33 @@ class MinMaxConfiguration {
     const Q &state() const { return _state; }
     bool is_bounded() const { return !_value.infinite; }
     unsigned int current_value() const { return _value.value; }
-    const std::vector<unsigned int> &values() const { return _counter_values; }
+    const CounterValues &values() const { return _counter_values; }
+
+    /// the hash of the configuration, computed once at construction
+    std::size_t hash() const { return _hash; }
+
+    /// returns true iff this configuration is on the same state as `other`, with higher counters
+    /// and a higher value
+    /// @remarks
+    ///     Operations on counters are monotonic, so that every run from `other` is matched by a run
+    ///     from this configuration with at least the same value.
+    bool dominates(const MinMaxConfiguration &other) const {
+        if (Comp()(_state, other._state) != 0)
+            return false;
+        if (!_value.infinite and (other._value.infinite or _value.value < other._value.value))
+            return false;
+        for (std::size_t k = 0; k != _counter_values.size(); ++k) {
+            if (_counter_values[k] < other._counter_values[k])
+                return false;
+        }
+        return true;
+    }
 
     /// usual comparison operators
     //@todo make them external operators?
     bool operator==(const MinMaxConfiguration &other) const {
-        return  Comp()(_state, other._state) == 0
+        return      _hash == other._hash
+            and Comp()(_state, other._state) == 0
             and _value.infinite == other._value.infinite
             and _value.value == other._value.value
             and _counter_values == other._counter_values;
@@ -146,13 +277,55 @@ class MinMaxConfiguration {
 
  private:
     // the state of the automaton
-    const Q _state;
+    Q _state;
     // the current value (must keep track of infinity)
     value_t _value;
     // the current values of the counters
-    std::vector<unsigned int> _counter_values;
+    CounterValues _counter_values;
+    // the hash of the configuration, that covers every field
+    std::size_t _hash;
+
+    std::size_t _compute_hash() const {
+        std::size_t res = std::hash<Q>()(_state);
+        res = hash_combine(res, _value.infinite);
+        res = hash_combine(res, _value.value);
+        res = hash_combine(res, _counter_values.hash());
+        return hash_mix(res);
+    }
 };
 
+/// the configuration reached from `source` through a transition to `sink` labeled by `label`
+/// @remarks
+///     Counters are incremented, checked, then reset, and the value of the run is the least of
+///     the checked counters. Counters saturate at the maximal value of those of `source`.
+template<typename Q, typename L>
+MinMaxConfiguration<Q> minmax_successor(const MinMaxConfiguration<Q> &source, const Q &sink,
+                                        const L &label) {
+    bool is_sink_bounded = source.is_bounded();
+    unsigned int current_value = source.current_value();
+    CounterValues values = source.values();
+    const auto &ops = label.get_operations();
+    for (std::size_t k = 0; k != ops.size(); ++k) {
+        const CounterOperation op = ops[k];
+        if (op & kIncrement) {
+            values.increment(k);
+        }
+        if (op & kCheck) {
+            if (!is_sink_bounded) {
+                is_sink_bounded = true;
+                current_value = values[k];
+            } else if (values[k] < current_value) {
+                current_value = values[k];
+            }
+        }
+        if (op & kReset) {
+            values.reset(k);
+        }
+    }
+    assert(source.is_bounded() ? (is_sink_bounded and current_value <= source.current_value()) : true);
+    return MinMaxConfiguration<Q>(sink, is_sink_bounded, current_value, values);
+}
+
 /// a class to represent the configuration automaton's TS
 template<typename Q, typename S, template<typename, typename> class TS>
 class MinMaxConfigTS : public TransitionSystem<MinMaxConfiguration<Q>, S> {
@@ -205,8 +378,8 @@ class MinMaxConfigTS : public TransitionSystem<MinMaxConfiguration<Q>, S> {
         else
             os << "inf";
         os << "|, [";
-        for (auto &v : q.values())
-            os << "," << v;
+        for (std::size_t k = 0; k != q.values().size(); ++k)
+            os << "," << q.values()[k];
         os << "])";
     }
 
@@ -244,29 +417,8 @@ class MinMaxConfigTS : public TransitionSystem<MinMaxConfiguration<Q>, S> {
         }
 
         TransitionPtr<MinMaxConfiguration<Q>, S> operator*() override {
-            bool is_sink_bounded = _source.is_bounded();
-            unsigned int current_value = _source.current_value();
-            std::vector<unsigned int> values = _source.values();
-            auto ops = (*_iterator)->label().get_operations();
-            for (std::size_t k = 0; k != ops.size(); ++k) {
-                assert(ops[k].size() == 1);
-                if (ops[k][0] & kIncrement) {
-                    values[k]++;
-                }
-                if (ops[k][0] & kCheck) {
-                    if (!is_sink_bounded) {
-                        is_sink_bounded = true;
-                        current_value = values[k];
-                    } else if (values[k] < current_value) {
-                        current_value = values[k];
-                    }
-                }
-                if (ops[k][0] & kReset) {
-                    values[k] = 0;
-                }
-            }
-            assert(_source.is_bounded() ? (is_sink_bounded and current_value <= _source.current_value()) : true);
-            auto res =_ts->add_transition(_source, MinMaxConfiguration<Q>((*_iterator)->sink(), is_sink_bounded, current_value, values), (*_iterator)->label());
+            auto t = *_iterator;
+            auto res = _ts->add_transition(_source, minmax_successor(_source, t->sink(), t->label()), t->label());
             return TransitionPtr<MinMaxConfiguration<Q>, S>(res, _ts->get_control_block());
         }
 
@@ -444,6 +596,91 @@ make_minmax_configuration_automaton(const CounterAutomaton<Q, S, TS> &a) {
     return MinMaxConfigurationAutomaton<Q,S,TS>(a);
 }
 
+/// A view (see TransitionSystemView.h) over the configurations of a counter automaton, given a
+/// view over its transition system.
+/// This is the statically dispatched counterpart of MinMaxConfigTS.
+template<typename View>
+class MinMaxConfigView {
+    using Q = typename View::state_type;
+
+ public:
+    typedef MinMaxConfiguration<Q> state_type;
+    typedef typename View::label_type label_type;
+
+    class edge_type {
+     public:
+        explicit edge_type(state_type &&sink, typename View::edge_type &&edge):
+            _sink(std::move(sink)), _edge(std::move(edge)) {}
+
+        const state_type &sink() const { return _sink; }
+        const label_type &label() const { return _edge.label(); }
+
+     private:
+        state_type _sink;
+        typename View::edge_type _edge;
+    };
+
+    class iterator {
+     public:
+        explicit iterator(const state_type &source, const typename View::iterator &it):
+            _source(source), _it(it) {}
+
+        bool operator!=(const iterator &rhs) const { return _it != rhs._it; }
+        iterator &operator++() {
+            ++_it;
+            return *this;
+        }
+        edge_type operator*() const {
+            auto edge = *_it;
+            auto sink = minmax_successor(_source, edge.sink(), edge.label());
+            return edge_type(std::move(sink), std::move(edge));
+        }
+
+     private:
+        state_type _source;
+        typename View::iterator _it;
+    };
+
+    /// @param  max_value   the value at which counters saturate (see CounterValues)
+    explicit MinMaxConfigView(const View &view, std::size_t nb_counters,
+                              unsigned int max_value = std::numeric_limits<unsigned int>::max()):
+        _view(view), _nb_counters(nb_counters), _max_value(max_value) {}
+
+    /// from s, return (s, \infty,  0 \dots 0)
+    state_type default_config(const Q &state) const {
+        return state_type(state, _nb_counters, _max_value);
+    }
+
+    ViewRange<iterator> successors(const state_type &state) const {
+        auto range = _view.successors(state.state());
+        return ViewRange<iterator>(iterator(state, range.begin()), iterator(state, range.end()));
+    }
+
+ private:
+    View _view;
+    std::size_t _nb_counters;
+    unsigned int _max_value;
+};
+
+/// builds a view over the transition system of a counter automaton
+template<typename Q, typename S, template<typename, typename> class TS>
+auto make_view(const CounterAutomaton<Q, S, TS> &aut) -> decltype(make_view(aut.transition_system())) {
+    return make_view(aut.transition_system());
+}
+
+/// builds a view over the configurations of a counter automaton
+/// @remarks
+///     `make_view(aut)` is found by argument-dependent lookup, so that specific automata (e.g.
+///     CounterAutomatonProduct) may provide their own view.
+/// @param  max_value   the value at which counters saturate. A supremum search up to `bound` only
+///                     needs `bound + 1`, which it then reports for any value beyond `bound`.
+template<typename Automaton>
+auto make_minmax_view(const Automaton &aut,
+                      unsigned int max_value = std::numeric_limits<unsigned int>::max())
+    -> MinMaxConfigView<decltype(make_view(aut))> {
+    return MinMaxConfigView<decltype(make_view(aut))>(make_view(aut), aut.num_counters(), max_value);
+}
+
 }  // namespace automata
 }  // namespace spaction
 
@@ -454,12 +691,7 @@ struct hash<spaction::automata::MinMaxConfiguration<Q>> {
     typedef spaction::automata::MinMaxConfiguration<Q> argument_type;
     typedef std::size_t result_type;
 
-    result_type operator()(const argument_type &c) const {
-        hash<std::pair<Q, std::vector<unsigned int>>> h;
-        auto v = c.values();
-        v.push_back(c.current_value());
-        return h(std::make_pair(c.state(), v));
-    }
+    result_type operator()(const argument_type &c) const { return c.hash(); }
 };
 
 }  // namespace std
@@ -0,0 +1,417 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_CONFIGURATIONSTORE_H_
+#define SPACTION_INCLUDE_AUTOMATA_CONFIGURATIONSTORE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "automata/ConfigurationAutomaton.h"
+#include "hash/hash.h"
+
+namespace spaction {
+namespace automata {
+
+/// A set of interned configurations, each one identified by a 32-bit id.
+/// @remarks
+///     Config must be a MinMaxConfiguration. A configuration is packed into a record of fixed
+///     size: the id of its state, whose highest bit tells whether it is unbounded, its value, and
+///     its counter values (see CounterValues::pack). Records are stored in chunks of growing size,
+///     per shard, with an open-addressing table of their indices. States are interned the same
+///     way, in tables of their own, but are never released.
+///     Interning a configuration takes a reference on its record, that `release` gives back: the
+///     record is freed with its last reference, and its id may then be reused. A search thus only
+///     keeps the configurations it refers to, e.g. from its DFS stack or its antichain of dead
+///     configurations (see SupremumFinder).
+///     The store is sharded by the hash of the records, each shard behind its own mutex, so that
+///     several searches may share it (see ParallelSupremumFinder). Chunks never move, and a record
+///     does not change while it is referred to, so that the record of a referred id is read
+///     without locking: it is compared in place, e.g. by ConfigurationAntichain, rather than
+///     rebuilt.
+template<typename Config>
+class ConfigurationStore {
+    typedef typename std::decay<decltype(std::declval<Config>().state())>::type Q;
+
+    enum : std::size_t {
+        kShardBits = 6,
+        kShards = std::size_t(1) << kShardBits,
+        kShardMask = kShards - 1,
+        /// the local ids of a shard, so that ids fit in 32 bits
+        kMaxLocalId = (std::size_t(1) << (32 - kShardBits)) - 1,
+        /// the number of records of the first chunk of a shard
+        kFirstChunkBits = 6,
+        kFirstChunkRecords = std::size_t(1) << kFirstChunkBits,
+        /// enough chunks for `kMaxLocalId + 1` records
+        kMaxChunks = 32 - kShardBits - kFirstChunkBits + 1,
+        /// the state id and the value
+        kHeaderWords = 2,
+        /// the size of the records that are packed without allocating
+        kInlineRecordWords = 16
+    };
+    enum : std::uint32_t { kUnboundedBit = std::uint32_t(1) << 31 };
+
+ public:
+    typedef std::uint32_t id_type;
+    typedef Config config_type;
+
+    /// a record being packed or unpacked
+    class RecordBuffer {
+     public:
+        explicit RecordBuffer(std::size_t words) {
+            if (words > kInlineRecordWords)
+                _heap.resize(words);
+        }
+        std::uint32_t *data() { return _heap.empty() ? _inline : _heap.data(); }
+
+     private:
+        std::uint32_t _inline[kInlineRecordWords];
+        std::vector<std::uint32_t> _heap;
+    };
+
+    /// @param  num_counters    the number of counters of every configuration
+    /// @param  max_value       the value at which counters saturate (see CounterValues)
+    explicit ConfigurationStore(std::size_t num_counters,
+                                unsigned int max_value = std::numeric_limits<unsigned int>::max())
+    : _num_counters(num_counters)
+    , _max_value(max_value)
+    , _record_words(kHeaderWords + CounterValues(num_counters, max_value).num_words()) {}
+
+    ConfigurationStore(const ConfigurationStore &) = delete;
+    ConfigurationStore &operator=(const ConfigurationStore &) = delete;
+
+    /// the id of `config`, that is interned first if needed
+    /// @remarks    this takes a reference on the configuration (see release)
+    id_type intern(const Config &config) {
+        RecordBuffer record(_record_words);
+        _pack(config, _intern_state(config.state()), record.data());
+        std::size_t hash = _record_hash(record.data());
+        Shard &shard = _shards[hash & kShardMask];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::size_t i = _probe(shard, record.data(), hash);
+        if (shard.slots[i] != 0) {
+            ++_references(shard, shard.slots[i] - 1);
+            return _make_id(hash & kShardMask, shard.slots[i] - 1);
+        }
+
+        std::size_t local;
+        if (!shard.free.empty()) {
+            local = shard.free.back();
+            shard.free.pop_back();
+        } else {
+            if (shard.count > kMaxLocalId)
+                throw std::length_error("too many configurations");
+            local = shard.count++;
+            _allocate(shard, local);
+        }
+        std::copy(record.data(), record.data() + _record_words, _record_at(shard, local));
+        _references(shard, local) = 1;
+        shard.slots[i] = static_cast<id_type>(local + 1);
+        ++shard.live;
+        ++shard.interned;
+        if (2 * shard.live > shard.slots.size())
+            _grow(shard);
+        return _make_id(hash & kShardMask, local);
+    }
+
+    /// Gives back a reference taken by intern, and frees the configuration interned as `id` with
+    /// its last reference.
+    void release(id_type id) {
+        Shard &shard = _shards[id & kShardMask];
+        std::size_t local = id >> kShardBits;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        assert(_references(shard, local) != 0);
+        if (--_references(shard, local) != 0)
+            return;
+        const std::uint32_t *record = _record_at(shard, local);
+        _erase_slot(shard, _probe(shard, record, _record_hash(record)));
+        shard.free.push_back(static_cast<id_type>(local));
+        --shard.live;
+    }
+
+    /// Looks `config` up, without interning it.
+    /// @return false iff `config` is not interned, otherwise its id is written to `id`
+    /// @remarks    no reference is taken, so that `id` may be released by another search
+    bool find(const Config &config, id_type &id) const {
+        RecordBuffer record(_record_words);
+        if (!pack(config, record.data()))
+            return false;
+        std::size_t hash = _record_hash(record.data());
+        const Shard &shard = _shards[hash & kShardMask];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        id_type slot = shard.slots[_probe(shard, record.data(), hash)];
+        if (slot == 0)
+            return false;
+        id = _make_id(hash & kShardMask, slot - 1);
+        return true;
+    }
+
+    /// the configuration interned as `id`, that the caller refers to
+    Config get(id_type id) const {
+        const std::uint32_t *record = this->record(id);
+        return Config(_state(state_of(record)), !(record[0] & kUnboundedBit), record[1],
+                      CounterValues::unpack(record + kHeaderWords, _num_counters, _max_value));
+    }
+
+    /// the number of words of a record
+    std::size_t record_words() const { return _record_words; }
+
+    /// the record of the configuration interned as `id`, that the caller refers to
+    /// @remarks    the record is read without locking, since it does not change nor move
+    const std::uint32_t *record(id_type id) const {
+        return _record_at(_shards[id & kShardMask], id >> kShardBits);
+    }
+
+    /// Packs `config` into `record`, without interning it.
+    /// @return false iff the state of `config` has never been interned, and nothing is written
+    bool pack(const Config &config, std::uint32_t *record) const {
+        id_type state_id;
+        if (!_find_state(config.state(), state_id))
+            return false;
+        _pack(config, state_id, record);
+        return true;
+    }
+
+    /// the id of the state of the configuration packed in `record`
+    static id_type state_of(const std::uint32_t *record) { return record[0] & ~kUnboundedBit; }
+
+    /// returns true iff the configuration interned as `id`, that the caller refers to, dominates
+    /// the one packed in `record` (see MinMaxConfiguration::dominates)
+    bool dominates(id_type id, const std::uint32_t *record) const {
+        const std::uint32_t *mine = this->record(id);
+        if (state_of(mine) != state_of(record))
+            return false;
+        if (!(mine[0] & kUnboundedBit) and ((record[0] & kUnboundedBit) or mine[1] < record[1]))
+            return false;
+        return CounterValues::packed_dominates(mine + kHeaderWords, record + kHeaderWords,
+                                               _num_counters, _max_value);
+    }
+
+    /// the number of configurations currently interned
+    std::size_t size() const {
+        std::size_t result = 0;
+        for (const auto &shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result += shard.live;
+        }
+        return result;
+    }
+
+    /// the number of configurations interned so far, including the released ones
+    std::size_t interned() const {
+        std::size_t result = 0;
+        for (const auto &shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result += shard.interned;
+        }
+        return result;
+    }
+
+    /// the number of bytes of the records and tables of the configurations
+    std::size_t memory() const {
+        std::size_t result = 0;
+        for (const auto &shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (std::size_t c = 0; c != kMaxChunks and shard.chunks[c]; ++c)
+                result += (kFirstChunkRecords << c) * _stride() * sizeof(std::uint32_t);
+            result += (shard.slots.capacity() + shard.free.capacity()) * sizeof(id_type);
+        }
+        return result;
+    }
+
+ private:
+    struct Shard {
+        explicit Shard() : slots(16, 0), count(0), live(0), interned(0) {}
+
+        mutable std::mutex mutex;
+        /// the records by local id, each one followed by its number of references: chunk c holds
+        /// the `kFirstChunkRecords << c` records from local id `kFirstChunkRecords * (2^c - 1)`
+        std::unique_ptr<std::uint32_t[]> chunks[kMaxChunks];
+        /// the open-addressing table of the records: local id + 1, or 0 for an empty slot
+        std::vector<id_type> slots;
+        /// the released local ids, to be reused
+        std::vector<id_type> free;
+        /// the number of local ids used so far
+        std::size_t count;
+        /// the number of records referred to
+        std::size_t live;
+        /// the number of records interned so far
+        std::size_t interned;
+    };
+
+    struct StateEqual {
+        bool operator()(const Q &l, const Q &r) const { return mycompare<Q>()(l, r) == 0; }
+    };
+
+    struct StateShard {
+        mutable std::mutex mutex;
+        std::unordered_map<Q, id_type, std::hash<Q>, StateEqual> ids;
+        /// the states, by local id
+        std::vector<Q> states;
+    };
+
+    std::size_t _num_counters;
+    unsigned int _max_value;
+    std::size_t _record_words;
+    Shard _shards[kShards];
+    StateShard _state_shards[kShards];
+
+    static inline id_type _make_id(std::size_t shard, std::size_t local) {
+        return static_cast<id_type>((local << kShardBits) | shard);
+    }
+
+    /// the number of words of a record and of its number of references
+    inline std::size_t _stride() const { return _record_words + 1; }
+
+    /// Packs `config`, whose state is interned as `state_id`, into `record`.
+    void _pack(const Config &config, id_type state_id, std::uint32_t *record) const {
+        record[0] = state_id | (config.is_bounded() ? 0 : kUnboundedBit);
+        record[1] = config.current_value();
+        assert(config.values().size() == _num_counters);
+        config.values().pack(record + kHeaderWords);
+    }
+
+    std::size_t _record_hash(const std::uint32_t *record) const {
+        return hash_mix(hash_range(_record_words, record, record + _record_words,
+                                   std::hash<std::uint32_t>()));
+    }
+
+    /// the chunk of local id `local`, whose index in the chunk is written to `offset`
+    static inline std::size_t _chunk_of(std::size_t local, std::size_t &offset) {
+        std::size_t c = 63 - __builtin_clzll(local / kFirstChunkRecords + 1);
+        offset = local - kFirstChunkRecords * ((std::size_t(1) << c) - 1);
+        return c;
+    }
+
+    /// the record of local id `local` in `shard`
+    std::uint32_t *_record_at(const Shard &shard, std::size_t local) const {
+        std::size_t offset;
+        std::size_t c = _chunk_of(local, offset);
+        return shard.chunks[c].get() + offset * _stride();
+    }
+
+    /// the number of references on the record of local id `local` in `shard`, that is locked
+    std::uint32_t &_references(const Shard &shard, std::size_t local) const {
+        return _record_at(shard, local)[_record_words];
+    }
+
+    /// Allocates the chunk of the new local id `local` of `shard`, if needed.
+    void _allocate(Shard &shard, std::size_t local) const {
+        std::size_t offset;
+        std::size_t c = _chunk_of(local, offset);
+        if (!shard.chunks[c])
+            shard.chunks[c].reset(new std::uint32_t[(kFirstChunkRecords << c) * _stride()]);
+    }
+
+    /// the slot of `record` in the table of `shard`
+    inline std::size_t _home(const Shard &shard, const std::uint32_t *record) const {
+        // the low bits of the hash select the shard
+        return (_record_hash(record) >> kShardBits) & (shard.slots.size() - 1);
+    }
+
+    /// the slot of the record equal to `record` in `shard`, or the empty slot where it belongs
+    std::size_t _probe(const Shard &shard, const std::uint32_t *record, std::size_t hash) const {
+        std::size_t mask = shard.slots.size() - 1;
+        for (std::size_t i = (hash >> kShardBits) & mask;; i = (i + 1) & mask) {
+            id_type slot = shard.slots[i];
+            if (slot == 0)
+                return i;
+            const std::uint32_t *other = _record_at(shard, slot - 1);
+            if (std::equal(record, record + _record_words, other))
+                return i;
+        }
+    }
+
+    /// Empties slot `i` of `shard`, and moves back the records after it that probing would not
+    /// reach any more (backward shift deletion).
+    void _erase_slot(Shard &shard, std::size_t i) const {
+        std::size_t mask = shard.slots.size() - 1;
+        for (std::size_t j = (i + 1) & mask; shard.slots[j] != 0; j = (j + 1) & mask) {
+            std::size_t home = _home(shard, _record_at(shard, shard.slots[j] - 1));
+            // the record of slot j stays iff its home is cyclically in ]i, j]
+            bool stays = (i <= j) ? (i < home and home <= j) : (i < home or home <= j);
+            if (!stays) {
+                shard.slots[i] = shard.slots[j];
+                i = j;
+            }
+        }
+        shard.slots[i] = 0;
+    }
+
+    /// Doubles the table of `shard`, and reinserts its records.
+    void _grow(Shard &shard) const {
+        std::vector<id_type> slots(2 * shard.slots.size(), 0);
+        shard.slots.swap(slots);
+        std::size_t mask = shard.slots.size() - 1;
+        for (id_type slot : slots) {
+            if (slot == 0)
+                continue;
+            std::size_t i = _home(shard, _record_at(shard, slot - 1));
+            while (shard.slots[i] != 0)
+                i = (i + 1) & mask;
+            shard.slots[i] = slot;
+        }
+    }
+
+    /// the id of state `q`, that is interned first if needed
+    id_type _intern_state(const Q &q) {
+        std::size_t shard_index = hash_mix(std::hash<Q>()(q)) & kShardMask;
+        StateShard &shard = _state_shards[shard_index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto insert_res = shard.ids.insert(std::make_pair(q, id_type(shard.states.size())));
+        if (insert_res.second) {
+            // the highest bit of the state word is the unbounded flag
+            if (shard.states.size() > (kMaxLocalId >> 1))
+                throw std::length_error("too many states");
+            shard.states.push_back(q);
+        }
+        return _make_id(shard_index, insert_res.first->second);
+    }
+
+    /// Looks up the id of state `q`.
+    /// @return false iff `q` has never been interned
+    bool _find_state(const Q &q, id_type &id) const {
+        std::size_t shard_index = hash_mix(std::hash<Q>()(q)) & kShardMask;
+        const StateShard &shard = _state_shards[shard_index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.ids.find(q);
+        if (it == shard.ids.end())
+            return false;
+        id = _make_id(shard_index, it->second);
+        return true;
+    }
+
+    /// the state interned as `id`
+    Q _state(id_type id) const {
+        const StateShard &shard = _state_shards[id & kShardMask];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.states[id >> kShardBits];
+    }
+};
+
+}  // namespace automata
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_CONFIGURATIONSTORE_H_
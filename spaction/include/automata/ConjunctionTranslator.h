@@ -0,0 +1,149 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_CONJUNCTIONTRANSLATOR_H_
+#define SPACTION_INCLUDE_AUTOMATA_CONJUNCTIONTRANSLATOR_H_
+
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BinaryOperator.h"
+#include "CltlFormulaFactory.h"
+#include "automata/CltlTranslator.h"
+#include "automata/CounterAutomatonProduct.h"
+#include "automata/CounterAutomatonSimplifier.h"
+
+namespace spaction {
+namespace automata {
+
+/// Translates a conjunction of CLTL formulae, by translating two halves of its conjuncts on their
+/// own thread, and combining the resulting automata with CounterAutomatonProduct.
+/// Each half is simplified (see CounterAutomatonSimplifier) before the product is built.
+/// @remarks
+///     Both halves share the factory of the formula, which is thread-safe.
+/// @remarks
+///     The conjuncts are always split in two halves, whatever the number of jobs, so that at
+///     most two threads translate them. Splitting them in more groups would need a tree of
+///     products, but the type of a product nests the types of its operands (see StateProd), so
+///     that each shape of tree is a distinct automaton type. The automaton type is a template
+///     argument of the product with the model, of the views and of the supremum search, all of
+///     which would be instantiated once more for each number of groups, chosen at run time. Two
+///     halves keep a single automaton type, whose product is the one the search already uses.
+class ConjunctionTranslator {
+ public:
+    /// the type of the automaton built
+    typedef CounterAutomatonProduct<CltlTranslator::Node*, CltlTranslator::FormulaList,
+                                    UndeterministicTransitionSystem,
+                                    CltlTranslator::Node*, CltlTranslator::FormulaList,
+                                    UndeterministicTransitionSystem,
+                                    AutLabelProduct> automaton_type;
+
+    /// `formula` is assumed to be a conjunction (see `is_conjunction`)
+    explicit ConjunctionTranslator(const CltlFormulaPtr &formula) {
+        assert(is_conjunction(formula));
+        std::vector<CltlFormulaPtr> conjuncts;
+        _collect_conjuncts(formula->to_nnf(), conjuncts);
+
+        // balance the work between both halves
+        std::size_t middle = conjuncts.size() / 2;
+        CltlFormulaFactory *factory = formula->creator();
+        _lhs_formula = conjuncts[0];
+        for (std::size_t i = 1; i != middle; ++i) {
+            _lhs_formula = factory->make_and(_lhs_formula, conjuncts[i]);
+        }
+        _rhs_formula = conjuncts[middle];
+        for (std::size_t i = middle + 1; i != conjuncts.size(); ++i) {
+            _rhs_formula = factory->make_and(_rhs_formula, conjuncts[i]);
+        }
+    }
+
+    /// returns true iff the negation normal form of `formula` is a conjunction
+    static bool is_conjunction(const CltlFormulaPtr &formula) {
+        const CltlFormulaPtr &nnf = formula->to_nnf();
+        return nnf->formula_type() == CltlFormula::kBinaryOperator
+            and static_cast<BinaryOperator*>(nnf.get())->operator_type() == BinaryOperator::kAnd;
+    }
+
+    void build_automaton() {
+        // the left half is translated on its own thread, the right one on the current thread
+        std::exception_ptr lhs_error;
+        std::thread lhs_thread([this, &lhs_error]() {
+            try {
+                _lhs.reset(new CltlTranslator(_lhs_formula));
+                _lhs->build_automaton();
+                CounterAutomatonSimplifier(_lhs->get_automaton()).run();
+            } catch (...) {
+                lhs_error = std::current_exception();
+            }
+        });
+
+        std::exception_ptr rhs_error;
+        try {
+            _rhs.reset(new CltlTranslator(_rhs_formula));
+            _rhs->build_automaton();
+            CounterAutomatonSimplifier(_rhs->get_automaton()).run();
+        } catch (...) {
+            rhs_error = std::current_exception();
+        }
+        lhs_thread.join();
+
+        if (lhs_error)
+            std::rethrow_exception(lhs_error);
+        if (rhs_error)
+            std::rethrow_exception(rhs_error);
+
+        _automaton.reset(new automaton_type(_lhs->get_automaton(), _rhs->get_automaton(),
+                                            _lhs_formula->creator()));
+    }
+
+    inline automaton_type &get_automaton() { return *_automaton; }
+
+    /// the translators of both halves, once the automaton is built
+    //@{
+    inline CltlTranslator &lhs() { return *_lhs; }
+    inline CltlTranslator &rhs() { return *_rhs; }
+    //@}
+
+ private:
+    CltlFormulaPtr _lhs_formula;
+    CltlFormulaPtr _rhs_formula;
+
+    std::unique_ptr<CltlTranslator> _lhs;
+    std::unique_ptr<CltlTranslator> _rhs;
+    std::unique_ptr<automaton_type> _automaton;
+
+    static void _collect_conjuncts(const CltlFormulaPtr &formula,
+                                   std::vector<CltlFormulaPtr> &conjuncts) {
+        if (formula->formula_type() == CltlFormula::kBinaryOperator) {
+            BinaryOperator *bo = static_cast<BinaryOperator*>(formula.get());
+            if (bo->operator_type() == BinaryOperator::kAnd) {
+                _collect_conjuncts(bo->left(), conjuncts);
+                _collect_conjuncts(bo->right(), conjuncts);
+                return;
+            }
+        }
+        conjuncts.push_back(formula);
+    }
+};
+
+}  // namespace automata
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_CONJUNCTIONTRANSLATOR_H_
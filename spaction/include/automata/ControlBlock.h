@@ -20,11 +20,25 @@
 
 #include <cstddef>
 #include <functional>
-#include <set>
 
 namespace spaction {
 namespace automata {
 
+template<typename T> class ControlBlock;
+
+/// The structure actually stored by the smart pointer (see TransitionPtr).
+/// @remarks
+///     Blocks are owned and recycled by their control block, see RefControlBlock.
+template<typename T>
+struct SmartBlock {
+    std::size_t _refcount;
+    const T *_pointer;
+    ControlBlock<T> *_control;
+    /// links to the neighbour blocks, in the list of blocks of the control block
+    SmartBlock *_prev;
+    SmartBlock *_next;
+};
+
 /// Control block interface.
 /// Acts as the real memory manager: pass it newly acquired pointers,
 /// and tell it to destroy the pointer when ref count reaches 0.
@@ -34,64 +48,81 @@ public:
     virtual ~ControlBlock() { }
 
     /// Called when an object starts being managed.
-    virtual void declare(const T *t) = 0;
-    /// Called when an object is no longer managed.
-    virtual void release(const T *t) = 0;
+    /// @return the block counting the references to `t`, with a count of 1, or nullptr if `t`
+    ///         outlives every reference to it, and thus needs no reference counting.
+    virtual SmartBlock<T> *declare(const T *t) = 0;
+    /// Called when an object is no longer managed, i.e. when the count of `block` reaches 0.
+    virtual void release(SmartBlock<T> *block) = 0;
 };
 
 /// A smart pointer manager with unique ownership semantics.
+/// @remarks
+///     Released blocks are kept in a free list and reused by the next declarations, so that once
+///     the number of simultaneously managed objects has peaked, managing an object allocates
+///     nothing.
 template<typename T>
 class RefControlBlock : public ControlBlock<T> {
  public:
-    explicit RefControlBlock(const std::function<void(const T *)> &d): _destroy(d) {}
+    explicit RefControlBlock(const std::function<void(const T *)> &d):
+        _used(nullptr), _free(nullptr), _destroy(d) {}
     ~RefControlBlock() {
-        for (auto &r : _pool) {
-            _destroy(r);
+        while (_used) {
+            SmartBlock<T> *block = _used;
+            _used = block->_next;
+            _destroy(block->_pointer);
+            delete block;
+        }
+        while (_free) {
+            SmartBlock<T> *block = _free;
+            _free = block->_next;
+            delete block;
         }
-        _pool.clear();
     }
 
-    /// Ensures that the declared object is not already managed.
-    /// Throws if already managed.
-    virtual void declare(const T *t) override {
-        if (_pool.count(t))
-            throw "object is already managed";
+    virtual SmartBlock<T> *declare(const T *t) override {
+        SmartBlock<T> *block = _free;
+        if (block)
+            _free = block->_next;
+        else
+            block = new SmartBlock<T>();
 
-        _pool.insert(t);
+        block->_refcount = 1;
+        block->_pointer = t;
+        block->_control = this;
+
+        // link the block at the head of the used blocks
+        block->_prev = nullptr;
+        block->_next = _used;
+        if (_used)
+            _used->_prev = block;
+        _used = block;
+        return block;
     }
 
-    /// Called when an object is no longer managed.
-    virtual void release(const T *t) override {
-        _pool.erase(t);
-        _destroy(t);
+    virtual void release(SmartBlock<T> *block) override {
+        // unlink the block from the used blocks
+        if (block->_prev)
+            block->_prev->_next = block->_next;
+        else
+            _used = block->_next;
+        if (block->_next)
+            block->_next->_prev = block->_prev;
+
+        _destroy(block->_pointer);
+
+        // recycle the block
+        block->_next = _free;
+        _free = block;
     }
 
  private:
-    /// @todo use another structure than std::set
-    std::set<const T *> _pool;
+    /// the blocks of the managed objects (doubly linked)
+    SmartBlock<T> *_used;
+    /// the blocks available for reuse (simply linked)
+    SmartBlock<T> *_free;
     std::function<void(const T *)> _destroy;
 };
 
-/// The structure actually stored by the smart pointer (see below).
-template<typename T>
-struct SmartBlock {
-    // are all default ctors, dtor, copy and move semantics OK?
-    std::size_t _refcount;
-    const T * const _pointer;
-    ControlBlock<T> * const _control;
-
-    /// constructor
-    explicit SmartBlock(size_t r, const T *p, ControlBlock<T> *cb):
-    _refcount(r), _pointer(p), _control(cb) {
-        // declare the newly managed pointer to the controller
-        _control->declare(_pointer);
-    }
-    /// destructor
-    ~SmartBlock() {
-        _control->release(_pointer);
-    }
-};
-
 }  // namespace automata
 }  // namespace spaction
 
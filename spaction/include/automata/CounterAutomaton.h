@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <ostream>
 #include <set>
 #include <unordered_map>
@@ -27,6 +28,8 @@
 
 #include "automata/TransitionSystem.h"
 #include "automata/TransitionSystemPrinter.h"
+#include "bitset/DynamicBitset.h"
+#include "hash/hash.h"
 
 namespace spaction {
 namespace automata {
@@ -46,9 +49,159 @@ inline CounterOperation operator|(const CounterOperation &l, const CounterOperat
 inline CounterOperation operator&(const CounterOperation &l, const CounterOperation &r) {
     return static_cast<CounterOperation>(static_cast<unsigned int>(l) & static_cast<unsigned int>(r));
 }
+inline CounterOperation operator~(const CounterOperation &c) {
+    return static_cast<CounterOperation>(~static_cast<unsigned int>(c) & (kIncrement | kCheck | kReset));
+}
 
 std::string print_counter_operation(CounterOperation c);
 
+/// The operations of a transition on each counter, packed on 3 bits per counter.
+/// @remarks
+///     The operations on a counter are a combination of kIncrement, kCheck and kReset, always
+///     applied in that order. Up to 42 counters fit inline, so that building, combining and slicing
+///     the operations of the usual labels (see TSLabelProdImpl) does not allocate.
+class CounterOperations {
+ public:
+    explicit CounterOperations(std::size_t counters = 0) : _bits(kBits * counters) {}
+
+    inline std::size_t size() const { return _bits.size() / kBits; }
+
+    inline CounterOperation operator[](std::size_t counter) const {
+        return static_cast<CounterOperation>(_bits.get(kBits * counter, kBits));
+    }
+
+    /// Sets the operations on `counter`.
+    inline void set(std::size_t counter, CounterOperation operation) {
+        _bits.put(kBits * counter, kBits, operation);
+    }
+    /// Adds `operation` to the operations on `counter`.
+    inline void add(std::size_t counter, CounterOperation operation) {
+        set(counter, (*this)[counter] | operation);
+    }
+    /// Removes `operation` from the operations on `counter`.
+    inline void remove(std::size_t counter, CounterOperation operation) {
+        _bits.put(kBits * counter, kBits, (*this)[counter] & ~operation);
+    }
+
+    /// Appends the operations on the counters of `other`.
+    inline void append(const CounterOperations &other) { _bits.append(other._bits); }
+
+    /// the operations on the counters [first, last[
+    inline CounterOperations slice(std::size_t first, std::size_t last) const {
+        return CounterOperations(_bits.slice(kBits * first, kBits * last));
+    }
+
+    inline bool operator==(const CounterOperations &other) const { return _bits == other._bits; }
+    inline bool operator!=(const CounterOperations &other) const { return _bits != other._bits; }
+
+    inline std::size_t hash() const { return _bits.hash(); }
+
+ private:
+    enum : std::size_t { kBits = 3 };
+
+    DynamicBitset _bits;
+
+    explicit CounterOperations(DynamicBitset &&bits) : _bits(std::move(bits)) {}
+};
+
+/// A set of acceptance conditions, as a bitset.
+/// @remarks
+///     The bitset is trimmed after its highest acceptance condition, so that equal sets have equal
+///     representations. Up to 128 acceptance conditions fit inline.
+class AcceptanceSet {
+ public:
+    /// iterator over the acceptance conditions of the set, in increasing order
+    class const_iterator {
+     public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::size_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::size_t *pointer;
+        typedef std::size_t reference;
+
+        explicit const_iterator(const DynamicBitset *bits, std::size_t i) : _bits(bits), _i(i) {}
+
+        inline std::size_t operator*() const { return _i; }
+        inline const_iterator &operator++() {
+            _i = _bits->find_next(_i);
+            return *this;
+        }
+        inline bool operator==(const const_iterator &rhs) const { return _i == rhs._i; }
+        inline bool operator!=(const const_iterator &rhs) const { return _i != rhs._i; }
+
+     private:
+        const DynamicBitset *_bits;
+        std::size_t _i;
+    };
+
+    explicit AcceptanceSet() {}
+    explicit AcceptanceSet(const std::set<std::size_t> &accs) {
+        for (auto a : accs)
+            insert(a);
+    }
+
+    inline const_iterator begin() const { return const_iterator(&_bits, _bits.find_first()); }
+    inline const_iterator end() const { return const_iterator(&_bits, DynamicBitset::npos); }
+
+    /// the number of acceptance conditions in the set
+    inline std::size_t size() const { return _bits.count(); }
+    inline bool empty() const { return _bits.size() == 0; }
+    inline std::size_t count(std::size_t acc) const { return acc < _bits.size() and _bits.test(acc); }
+
+    void insert(std::size_t acc) {
+        if (acc >= _bits.size())
+            _bits.resize(acc + 1);
+        _bits.set(acc);
+    }
+
+    AcceptanceSet &operator|=(const AcceptanceSet &other) {
+        if (other._bits.size() > _bits.size())
+            _bits.resize(other._bits.size());
+        _bits |= other._bits;
+        return *this;
+    }
+
+    /// returns true iff every acceptance condition of `other` is in `*this`
+    inline bool includes(const AcceptanceSet &other) const { return _bits.includes(other._bits); }
+
+    /// the acceptance conditions lower than `bound`
+    AcceptanceSet below(std::size_t bound) const {
+        AcceptanceSet result(_bits.slice(0, std::min(bound, _bits.size())));
+        result._trim();
+        return result;
+    }
+    /// the acceptance conditions greater or equal to `bound`, shifted down by `bound`
+    AcceptanceSet above(std::size_t bound) const {
+        if (bound >= _bits.size())
+            return AcceptanceSet();
+        return AcceptanceSet(_bits.slice(bound, _bits.size()));
+    }
+    /// the acceptance conditions of the set, shifted up by `offset`
+    AcceptanceSet shifted(std::size_t offset) const {
+        if (empty())
+            return AcceptanceSet();
+        AcceptanceSet result{DynamicBitset(offset)};
+        result._bits.append(_bits);
+        return result;
+    }
+
+    inline bool operator==(const AcceptanceSet &other) const { return _bits == other._bits; }
+    inline bool operator!=(const AcceptanceSet &other) const { return _bits != other._bits; }
+
+    inline std::size_t hash() const { return _bits.hash(); }
+
+ private:
+    DynamicBitset _bits;
+
+    explicit AcceptanceSet(DynamicBitset &&bits) : _bits(std::move(bits)) {}
+
+    /// drops the bits above the highest acceptance condition
+    void _trim() {
+        std::size_t last = _bits.find_last();
+        _bits.resize(last == DynamicBitset::npos ? 0 : last + 1);
+    }
+};
+
 }  // namespace automata
 }  // namespace spaction
 
@@ -177,9 +330,20 @@ template<typename S> class CounterLabel {
         _operations(counters), _hash_dirty(true) {
     }
 
+    explicit CounterLabel(const S &letter, const CounterOperations &operations,
+                          const AcceptanceSet &accs) :
+        _letter(letter), _operations(operations), _acceptance_conditions(accs), _hash_dirty(true) {
+    }
+
+    /// @remarks    the operations on each counter are packed (see CounterOperations)
     explicit CounterLabel(const S &letter, const std::vector<CounterOperationList> &operations,
                           const std::set<std::size_t> &accs) :
-        _letter(letter), _operations(operations), _acceptance_conditions(accs), _hash_dirty(true) {
+        _letter(letter), _operations(operations.size()), _acceptance_conditions(accs),
+        _hash_dirty(true) {
+        for (std::size_t k = 0; k != operations.size(); ++k) {
+            for (auto operation : operations[k])
+                _operations.add(k, operation);
+        }
     }
 
     bool operator==(const CounterLabel<S>& rhs) const {
@@ -190,13 +354,10 @@ template<typename S> class CounterLabel {
 
     std::size_t hash() const {
         if (_hash_dirty) {
-            _hash_value = std::hash<S>()(_letter);
-            for (auto counter : _operations) {
-                std::size_t i = 0;
-                for (auto operation : counter)
-                    i ^= operation;
-                _hash_value ^= i;
-            }
+            std::size_t res = std::hash<S>()(_letter);
+            res = hash_combine(res, _operations.hash());
+            res = hash_combine(res, _acceptance_conditions.hash());
+            _hash_value = hash_mix(res);
             _hash_dirty = false;
         }
         return _hash_value;
@@ -206,42 +367,35 @@ template<typename S> class CounterLabel {
 
     inline std::size_t num_counters() const { return _operations.size(); }
 
-    /// Sets a CounterOperation on a counter.
-    /// @todo deprecated by `get_operations`?
-    inline const CounterOperationList counter_operations(std::size_t counter) const {
+    /// Retrieves the operations set for a particular counter.
+    inline CounterOperation counter_operation(std::size_t counter) const {
         return _operations[counter];
     }
 
-    /// Retrieves the operations set for a particular counter.
+    /// Adds an operation on a particular counter.
     /// @remarks
-    ///     Counter operations are stored in a FIFO list, and will be applied to a counter in that
-    ///     order. This method always adds `operation` at the end of the list.
+    ///     Operations on a counter are always applied in the same order: increment, check, then
+    ///     reset (see CounterOperations).
     void add_counter_operation(std::size_t counter, CounterOperation operation) {
-        _operations[counter].push_back(operation);
+        _operations.add(counter, operation);
         _hash_dirty = true;
     }
 
     /// Removes an operation set for a particular counter.
-    /// @remarks
-    ///     Counter operations are stored in a FIFO list, and will be applied to a counter in that
-    ///     order. This method always erases the first occurence of `operation` within the list.
     void remove_counter_operation(std::size_t counter, CounterOperation operation) {
-        CounterOperationList &list = _operations[counter];
-        auto it = std::find(list.begin(), list.end(), operation);
-        if (it != list.end()) {
-            list.erase(it);
-        }
+        _operations.remove(counter, operation);
+        _hash_dirty = true;
     }
 
-    /// Gets the vector of counter operations.
-    const std::vector<CounterOperationList> &get_operations() const { return _operations; }
+    /// Gets the counter operations.
+    const CounterOperations &get_operations() const { return _operations; }
     /// Gets the set of acceptance conditions.
-    const std::set<std::size_t> &get_acceptance() const { return _acceptance_conditions; }
+    const AcceptanceSet &get_acceptance() const { return _acceptance_conditions; }
 
  private:
     const S _letter;
-    std::vector<CounterOperationList> _operations;
-    std::set<std::size_t> _acceptance_conditions;
+    CounterOperations _operations;
+    AcceptanceSet _acceptance_conditions;
 
     /// This flag indicates if the actual hash function must be computed when hash() is called.
     /// @remarks
@@ -256,12 +410,7 @@ template<typename S>
 std::ostream &operator<<(std::ostream &os, const CounterLabel<S>& label) {
     os << "{" << label.letter() << "}" <<  ":[";
     for (std::size_t i = 0; i < label.num_counters(); ++i) {
-        const CounterOperationList &counter = label.counter_operations(i);
-        os << "(";
-        for (auto c : counter) {
-            os << print_counter_operation(c) << ",";
-        }
-        os << "),";
+        os << "(" << print_counter_operation(label.counter_operation(i)) << ",),";
     }
     os << "]" << std::endl;
     // print acceptance conditions
@@ -20,6 +20,7 @@
 
 #include "automata/CounterAutomaton.h"
 #include "automata/TransitionSystemProduct.h"
+#include "automata/TransitionSystemView.h"
 
 namespace spaction {
 namespace automata {
@@ -114,35 +115,21 @@ class TSLabelProdImpl<  CounterLabel<L1>, CounterLabel<L2>,
     ~TSLabelProdImpl() {}
 
     const CounterLabel<L1> lhs(const CounterLabel<P> &cl) const override {
-        // keep the `_counter_offset` first counters
-        std::vector<CounterOperationList> left_ops(cl.get_operations().begin(),
-                                                   cl.get_operations().begin() + _counter_offset);
-
-        // keep the acceptance conditions below `_acceptance_offset`
-        std::set<std::size_t> left_accs(cl.get_acceptance().begin(),
-                                        cl.get_acceptance().lower_bound(_acceptance_offset));
-
-        // rebuild a CounterLabel
-        return CounterLabel<L1>(_lhandler.lhs(cl.letter()), left_ops, left_accs);
+        // keep the `_counter_offset` first counters, and the acceptance conditions below
+        // `_acceptance_offset`
+        return CounterLabel<L1>(_lhandler.lhs(cl.letter()),
+                                cl.get_operations().slice(0, _counter_offset),
+                                cl.get_acceptance().below(_acceptance_offset));
     }
 
     const CounterLabel<L2> rhs(const CounterLabel<P> &cl) const override {
-        // remove the `_counter_offset` first counters
-        std::vector<CounterOperationList> right_ops(cl.get_operations().begin() + _counter_offset,
-                                                    cl.get_operations().end());
-        assert(right_ops.size() + _counter_offset == cl.get_operations().size());
-
-        std::set<std::size_t> right_accs;
-        // keep the acceptance conditions above `_acceptance_offset`, and shift them down
-        std::transform(cl.get_acceptance().lower_bound(_acceptance_offset),
-                       cl.get_acceptance().end(),
-                       std::inserter(right_accs, right_accs.end()),
-                       [this](std::size_t x) {
-                           assert(x >= _acceptance_offset);
-                           return x - _acceptance_offset; });
-
-        // rebuild a CounterLabel
-        return CounterLabel<L2>(_lhandler.rhs(cl.letter()), right_ops, right_accs);
+        // remove the `_counter_offset` first counters, keep the acceptance conditions above
+        // `_acceptance_offset`, and shift them down
+        const CounterOperations &ops = cl.get_operations();
+        assert(ops.size() >= _counter_offset);
+        return CounterLabel<L2>(_lhandler.rhs(cl.letter()),
+                                ops.slice(_counter_offset, ops.size()),
+                                cl.get_acceptance().above(_acceptance_offset));
     }
 
     const CounterLabel<P>
@@ -150,15 +137,12 @@ class TSLabelProdImpl<  CounterLabel<L1>, CounterLabel<L2>,
         assert(l.get_operations().size() == _counter_offset);
 
         // regroup the counter operations
-        std::vector<CounterOperationList> counters;
-        counters.insert(counters.end(), l.get_operations().begin(), l.get_operations().end());
-        counters.insert(counters.end(), r.get_operations().begin(), r.get_operations().end());
+        CounterOperations counters(l.get_operations());
+        counters.append(r.get_operations());
 
         // regroup the acceptance conditions, by shifting up those from `r`
-        std::set<std::size_t> accs(l.get_acceptance().begin(), l.get_acceptance().end());
-        std::transform(r.get_acceptance().begin(), r.get_acceptance().end(),
-                       std::inserter(accs, accs.end()),
-                       [this](std::size_t x) { return x + _acceptance_offset; });
+        AcceptanceSet accs(l.get_acceptance());
+        accs |= r.get_acceptance().shifted(_acceptance_offset);
 
         // rebuild a CounterLabel
         return CounterLabel<P>(_lhandler.build(l.letter(), r.letter()), counters, accs);
@@ -249,6 +233,21 @@ class CounterAutomatonProduct: public CAPBase<Q1, S1, TS1, Q2, S2, TS2, LabelPro
     /// @todo no other methods to overload?
 };
 
+/// builds a view (see TransitionSystemView.h) over the product, made of the views over its operands
+template<   typename Q1, typename S1, template<typename Q1_, typename S1_> class TS1,
+            typename Q2, typename S2, template<typename Q2_, typename S2_> class TS2,
+            template<typename S1_, typename S2_> class LabelProduct>
+auto make_view(const CounterAutomatonProduct<Q1, S1, TS1, Q2, S2, TS2, LabelProduct> &aut)
+    -> decltype(make_product_view(make_view(std::declval<TS1<Q1, CounterLabel<S1>>*>()),
+                                  make_view(std::declval<TS2<Q2, CounterLabel<S2>>*>()),
+                                  &aut.transition_system()->helper())) {
+    auto ts = aut.transition_system();
+    // the operands of the product are the transition systems of the operand automata
+    return make_product_view(make_view(static_cast<TS1<Q1, CounterLabel<S1>>*>(ts->lhs())),
+                             make_view(static_cast<TS2<Q2, CounterLabel<S2>>*>(ts->rhs())),
+                             &ts->helper());
+}
+
 }  // namespace automata
 }  // namespace spaction
 
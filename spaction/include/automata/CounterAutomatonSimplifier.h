@@ -0,0 +1,134 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_COUNTERAUTOMATONSIMPLIFIER_H_
+#define SPACTION_INCLUDE_AUTOMATA_COUNTERAUTOMATONSIMPLIFIER_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "automata/CltlTranslator.h"
+
+namespace spaction {
+namespace automata {
+
+/// The effect of a simplification pass on the size of an automaton.
+struct SimplificationReport {
+    std::string pass;
+    std::size_t states_before;
+    std::size_t states_after;
+    std::size_t transitions_before;
+    std::size_t transitions_after;
+    std::size_t counters_before;
+    std::size_t counters_after;
+};
+
+std::ostream &operator<<(std::ostream &os, const SimplificationReport &report);
+
+/// Simplification passes over the counter automata built by CltlTranslator.
+/// @remarks
+///     The passes preserve the accepted words, and the value of each of them: a transition is only
+///     ever replaced by one with the same operations on the counters that are checked, a weaker
+///     letter and more acceptance conditions. They are
+///         * `prune`: removes the transitions with an unsatisfiable letter, and keeps only the
+///           states both reachable from the initial state and co-reachable from an accepting SCC;
+///         * `reduce_counters`: drops the counters that are never checked along an accepting run,
+///           and keeps a single one of the counters with the same operations on every transition;
+///         * `remove_subsumed_transitions`: between two states, removes the transitions subsumed
+///           by another one, ie. with the same counter operations, a stronger letter and fewer
+///           acceptance conditions;
+///         * `merge_equivalent_states`: merges the states that simulate each other, where a
+///           transition may only be simulated by one with the same counter operations (direct
+///           simulation).
+///     The passes work on a copy of the graph, that `run` and `apply` write back to the automaton.
+///     The nodes of the automaton are owned by the translator, that must outlive the simplifier.
+class CounterAutomatonSimplifier {
+ public:
+    typedef CltlTranslator::automaton_type automaton_type;
+    typedef CounterLabel<CltlTranslator::FormulaList> label_type;
+
+    explicit CounterAutomatonSimplifier(automaton_type &automaton);
+
+    /// Runs all the passes, then writes the result back to the automaton.
+    /// @return the reports of the passes run
+    const std::vector<SimplificationReport> &run();
+
+    /// the passes, see the class description
+    //@{
+    const SimplificationReport &prune();
+    const SimplificationReport &reduce_counters();
+    const SimplificationReport &remove_subsumed_transitions();
+    const SimplificationReport &merge_equivalent_states();
+    //@}
+
+    /// Replaces the automaton by the simplified one, frozen.
+    void apply();
+
+    const std::vector<SimplificationReport> &reports() const { return _reports; }
+
+ private:
+    /// a transition of the graph, between states given by their index in `_states`
+    struct Edge {
+        std::size_t source;
+        std::size_t sink;
+        label_type label;
+    };
+
+    automaton_type &_automaton;
+
+    std::vector<CltlTranslator::Node*> _states;
+    std::size_t _initial;
+    std::vector<Edge> _edges;
+    std::size_t _num_counters;
+
+    std::vector<SimplificationReport> _reports;
+
+    /// Opens the report of a pass, with the current size of the graph.
+    void _begin_report(const std::string &pass);
+    /// Closes the last report, with the current size of the graph.
+    const SimplificationReport &_end_report();
+
+    /// The SCCs of the part of the graph reachable from the initial state.
+    struct SCCDecomposition {
+        /// the SCC of each state, or `npos` for the unreachable ones
+        /// @remarks    SCCs are numbered in reverse topological order
+        std::vector<std::size_t> scc;
+        /// whether the inner transitions of each SCC form a cycle visiting every acceptance set
+        std::vector<bool> accepting;
+    };
+    enum : std::size_t { npos = static_cast<std::size_t>(-1) };
+
+    /// Computes the SCCs of the graph (Tarjan).
+    SCCDecomposition _decompose() const;
+    /// The states that may lie on an accepting run, ie. that are both reachable from the initial
+    /// state and co-reachable from an accepting SCC.
+    std::vector<bool> _useful_states() const;
+
+    /// Keeps the states for which `keep` holds, and the transitions between them.
+    void _restrict(const std::vector<bool> &keep);
+
+    /// Whether the transition labeled by `l` may replace the one labeled by `r`.
+    static bool _subsumes(const label_type &l, const label_type &r);
+    /// Whether the letter of `label` can never be satisfied.
+    static bool _is_false(const label_type &label);
+};
+
+}  // namespace automata
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_COUNTERAUTOMATONSIMPLIFIER_H_
@@ -0,0 +1,180 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_EXPLICITVIEW_H_
+#define SPACTION_INCLUDE_AUTOMATA_EXPLICITVIEW_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "automata/ConfigurationAutomaton.h"
+
+namespace spaction {
+namespace automata {
+
+/// A view (see TransitionSystemView.h) over an explicit copy of the part of a counter automaton
+/// reachable from a state.
+/// @remarks
+///     States are numbered from 0, the initial one, and labels only keep what configurations
+///     depend on: counter operations and acceptance conditions. Once built, the view is immutable
+///     and does not refer to the original automaton any more, so that several threads may explore
+///     it (see ParallelSupremumFinder), whereas exploring a product may build BDDs, which is not
+///     thread-safe. Copies of the view share the graph.
+class ExplicitView {
+ public:
+    typedef unsigned int state_type;
+
+    /// the letterless label of a transition
+    class label_type {
+     public:
+        explicit label_type(const CounterOperations &operations, const AcceptanceSet &accs):
+            _operations(operations), _acceptance_conditions(accs) {}
+
+        const CounterOperations &get_operations() const { return _operations; }
+        const AcceptanceSet &get_acceptance() const { return _acceptance_conditions; }
+
+     private:
+        CounterOperations _operations;
+        AcceptanceSet _acceptance_conditions;
+    };
+
+ private:
+    struct Edge {
+        state_type sink;
+        label_type label;
+    };
+
+ public:
+    class edge_type {
+     public:
+        explicit edge_type(const Edge *edge): _edge(edge) {}
+
+        const state_type &sink() const { return _edge->sink; }
+        const label_type &label() const { return _edge->label; }
+
+     private:
+        const Edge *_edge;
+    };
+
+    /// iterates over the successors of a state, in the order of `order` if it is not null
+    class iterator {
+     public:
+        explicit iterator(const Edge *first, const std::uint32_t *order, std::size_t i):
+            _first(first), _order(order), _i(i) {}
+
+        bool operator!=(const iterator &rhs) const { return _i != rhs._i; }
+        iterator &operator++() {
+            ++_i;
+            return *this;
+        }
+        edge_type operator*() const { return edge_type(_first + (_order ? _order[_i] : _i)); }
+
+     private:
+        const Edge *_first;
+        const std::uint32_t *_order;
+        std::size_t _i;
+    };
+
+    /// Copies the part of `view` reachable from `initial_state`.
+    /// @remarks    the false transitions are those the view does not yield
+    template<typename View>
+    explicit ExplicitView(const View &view, const typename View::state_type &initial_state) {
+        typedef typename View::state_type Q;
+        auto hash = [](const Q &q) { return std::hash<Q>()(q); };
+        auto equal = [](const Q &l, const Q &r) { return mycompare<Q>()(l, r) == 0; };
+        std::unordered_map<Q, state_type, decltype(hash), decltype(equal)> ids(16, hash, equal);
+
+        // states are numbered in BFS order
+        auto graph = std::make_shared<Graph>();
+        std::vector<Q> todo;
+        ids.insert(std::make_pair(initial_state, 0));
+        todo.push_back(initial_state);
+        for (std::size_t i = 0; i != todo.size(); ++i) {
+            graph->offsets.push_back(graph->edges.size());
+            for (auto edge : view.successors(todo[i])) {
+                auto insert_res = ids.insert(std::make_pair(edge.sink(), todo.size()));
+                if (insert_res.second)
+                    todo.push_back(edge.sink());
+                const auto &label = edge.label();
+                graph->edges.push_back(Edge{insert_res.first->second,
+                                            label_type(label.get_operations(),
+                                                       label.get_acceptance())});
+            }
+        }
+        graph->offsets.push_back(graph->edges.size());
+        _graph = graph;
+    }
+
+    /// a copy of the view, that yields the successors of each state in another order
+    /// @remarks
+    ///     The successors of each state are randomly permuted, by a generator seeded with `seed`,
+    ///     and the seed 0 keeps the original order. The copy shares the graph, but not the
+    ///     permutation, that takes a word per transition.
+    ExplicitView shuffled(std::size_t seed) const {
+        ExplicitView result(*this);
+        if (seed == 0) {
+            result._order.reset();
+            return result;
+        }
+        auto order = std::make_shared<std::vector<std::uint32_t>>(num_transitions());
+        std::mt19937 generator(static_cast<std::mt19937::result_type>(seed));
+        for (std::size_t q = 0; q != num_states(); ++q) {
+            auto first = order->begin() + _graph->offsets[q];
+            auto last = order->begin() + _graph->offsets[q + 1];
+            std::iota(first, last, 0);
+            std::shuffle(first, last, generator);
+        }
+        result._order = order;
+        return result;
+    }
+
+    state_type initial_state() const { return 0; }
+    std::size_t num_states() const { return _graph->offsets.size() - 1; }
+    std::size_t num_transitions() const { return _graph->edges.size(); }
+
+    ViewRange<iterator> successors(const state_type &state) const {
+        const Edge *first = _graph->edges.data() + _graph->offsets[state];
+        const std::uint32_t *order = _order ? _order->data() + _graph->offsets[state] : nullptr;
+        std::size_t degree = _graph->offsets[state + 1] - _graph->offsets[state];
+        return ViewRange<iterator>(iterator(first, order, 0), iterator(first, order, degree));
+    }
+
+    void print_state(std::ostream &os, const state_type &q) const { os << q; }
+
+ private:
+    /// the successors of state `q` are `edges[offsets[q]]` to `edges[offsets[q + 1]]` excluded
+    struct Graph {
+        std::vector<std::size_t> offsets;
+        std::vector<Edge> edges;
+    };
+
+    std::shared_ptr<const Graph> _graph;
+    /// the successors of `q` are yielded in the order `edges[offsets[q] + order[offsets[q] + i]]`,
+    /// or in the order of the graph if there is no permutation
+    std::shared_ptr<const std::vector<std::uint32_t>> _order;
+};
+
+}  // namespace automata
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_EXPLICITVIEW_H_
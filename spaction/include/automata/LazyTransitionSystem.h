@@ -0,0 +1,111 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_LAZYTRANSITIONSYSTEM_H_
+#define SPACTION_INCLUDE_AUTOMATA_LAZYTRANSITIONSYSTEM_H_
+
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+#include "automata/TransitionSystemView.h"
+#include "automata/UndeterministicTransitionSystem.h"
+
+namespace spaction {
+namespace automata {
+
+/// A transition system whose transitions are built on the fly.
+/// @remarks
+///     The successors of a state are computed by the expander the first time they are requested,
+///     and are then stored as in an UndeterministicTransitionSystem. The expander is expected to
+///     add the outgoing transitions of the state (and their sinks) to the transition system.
+/// @note
+///     Enumerating the states requires the whole reachable part to be built, and `freeze` only
+///     captures the states expanded so far.
+template<typename Q, typename S>
+class LazyTransitionSystem : public UndeterministicTransitionSystem<Q, S> {
+    using super_type = UndeterministicTransitionSystem<Q, S>;
+
+ public:
+    typedef std::function<void (LazyTransitionSystem<Q, S> &, const Q &)> Expander;
+
+    explicit LazyTransitionSystem() {}
+
+    void set_expander(const Expander &expander) { _expander = expander; }
+
+    /// Builds the successors of `state`, unless it was already done.
+    void expand(const Q &state) {
+        if (!_expander or !_expanded.insert(state).second)
+            return;
+        _expander(*this, state);
+    }
+
+    inline bool is_expanded(const Q &state) const { return _expanded.count(state) != 0; }
+
+    /// Builds the successors of every state reachable from the states known so far.
+    void expand_all() {
+        std::vector<Q> to_expand;
+        do {
+            to_expand.clear();
+            // `expand` adds states, so that the graph cannot be walked while expanding
+            for (auto &it : this->_graph) {
+                if (!is_expanded(it.first))
+                    to_expand.push_back(it.first);
+            }
+            for (auto &q : to_expand) {
+                expand(q);
+            }
+        } while (!to_expand.empty());
+    }
+
+ protected:
+    virtual typename TransitionSystem<Q, S>::TransitionBaseIterator *_successor_begin(const Q &state,
+                                                                                      const S *label) override {
+        expand(state);
+        return super_type::_successor_begin(state, label);
+    }
+
+    virtual typename TransitionSystem<Q, S>::TransitionBaseIterator *_successor_end(const Q &state) override {
+        expand(state);
+        return super_type::_successor_end(state);
+    }
+
+    virtual typename TransitionSystem<Q, S>::StateBaseIterator *_state_begin() override {
+        expand_all();
+        return super_type::_state_begin();
+    }
+    virtual typename TransitionSystem<Q, S>::StateBaseIterator *_state_end() override {
+        expand_all();
+        return super_type::_state_end();
+    }
+
+ private:
+    Expander _expander;
+    std::unordered_set<Q> _expanded;
+};
+
+/// The view over a lazy transition system goes through its successor interface, that builds the
+/// transitions on demand (a frozen view would only see the states already expanded).
+template<typename Q, typename S>
+TransitionSystemView<Q, S> make_view(LazyTransitionSystem<Q, S> *ts) {
+    return TransitionSystemView<Q, S>(ts);
+}
+
+}  // namespace automata
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_LAZYTRANSITIONSYSTEM_H_
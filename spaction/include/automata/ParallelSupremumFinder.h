@@ -0,0 +1,124 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_PARALLELSUPREMUMFINDER_H_
+#define SPACTION_INCLUDE_AUTOMATA_PARALLELSUPREMUMFINDER_H_
+
+#include <exception>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "automata/ExplicitView.h"
+#include "automata/SupremumFinder.h"
+
+namespace spaction {
+namespace automata {
+
+/// A class to compute the supremum of a counter automaton with several threads.
+/// @remarks
+///     The part of the automaton reachable from its initial state is first copied to an
+///     ExplicitView, on the current thread, since exploring a product is not thread-safe. Then
+///     `jobs` SupremumFinder run in parallel over its configurations, each one visiting the
+///     successors of each state in its own random permutation (swarm verification).
+///     They share the best value found, so that each one prunes the configurations that cannot
+///     improve it, and all stop as soon as one of them is done: it has explored the whole
+///     configuration automaton, up to pruning, or found a value beyond the bound.
+///     The searches intern their configurations in a single ConfigurationStore, and share a
+///     single antichain of dead configurations, so that none of them explores again what another
+///     one has completed. The configurations on the stack of a search are not shared though:
+///     each search numbers its own, to find its SCCs, so that several searches may explore the
+///     same configuration until one of them completes it.
+class ParallelSupremumFinder {
+ public:
+    /// @param  view        a view over the transition system of the counter automaton (see
+    ///                     make_view)
+    /// @param  max_value   the value at which counters saturate (see CounterValues)
+    template<typename View>
+    explicit ParallelSupremumFinder(const View &view,
+                                    const typename View::state_type &initial_state,
+                                    std::size_t num_counters, std::size_t num_acceptance_sets,
+                                    unsigned int jobs,
+                                    unsigned int max_value = std::numeric_limits<unsigned int>::max())
+    : _view(view, initial_state)
+    , _num_counters(num_counters)
+    , _num_acceptance_sets(num_acceptance_sets)
+    , _jobs(jobs == 0 ? 1 : jobs)
+    , _max_value(max_value)
+    , _interned_configurations(0) {}
+
+    /// the explicit copy of the automaton, that the searches explore
+    const ExplicitView &explicit_view() const { return _view; }
+
+    /// the number of configurations interned by the last call to find_supremum
+    std::size_t interned_configurations() const { return _interned_configurations; }
+
+    /// computes the supremum, see SupremumFinder::find_supremum
+    value_t find_supremum(unsigned int bound) {
+        SharedSupremum shared;
+        auto store = std::make_shared<store_type>(_num_counters, _max_value);
+        auto dead = std::make_shared<antichain_type>(*store);
+        std::vector<std::thread> workers;
+        std::vector<std::exception_ptr> errors(_jobs);
+        for (unsigned int i = 0; i != _jobs; ++i) {
+            workers.emplace_back([this, i, bound, &shared, &store, &dead, &errors]() {
+                try {
+                    MinMaxConfigView<ExplicitView> config_view(_view.shuffled(i), _num_counters,
+                                                               _max_value);
+                    auto finder = make_sup_comput(config_view,
+                                                  config_view.default_config(_view.initial_state()),
+                                                  _num_acceptance_sets);
+                    finder.share(&shared);
+                    finder.share_store(store, dead);
+                    finder.find_supremum(bound);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                    // the other searches cannot tell whether this one would have been done
+                    shared.done.store(true);
+                }
+            });
+        }
+        for (auto &worker : workers)
+            worker.join();
+        for (auto &error : errors) {
+            if (error)
+                std::rethrow_exception(error);
+        }
+        _interned_configurations = store->interned();
+
+        if (shared.infinite.load())
+            return { true, 0 };
+        return { false, shared.max_value.load() };
+    }
+
+ private:
+    typedef SupremumFinder<MinMaxConfigView<ExplicitView>>::store_type store_type;
+    typedef SupremumFinder<MinMaxConfigView<ExplicitView>>::antichain_type antichain_type;
+
+    ExplicitView _view;
+    std::size_t _num_counters;
+    std::size_t _num_acceptance_sets;
+    unsigned int _jobs;
+    unsigned int _max_value;
+    std::size_t _interned_configurations;
+};
+
+}  // namespace automata
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_PARALLELSUPREMUMFINDER_H_
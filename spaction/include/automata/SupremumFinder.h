@@ -18,24 +18,120 @@
 #ifndef SPACTION_INCLUDE_AUTOMATA_SUPREMUMFINDER_H_
 #define SPACTION_INCLUDE_AUTOMATA_SUPREMUMFINDER_H_
 
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "automata/ConfigurationAntichain.h"
 #include "automata/ConfigurationAutomaton.h"
+#include "automata/ConfigurationStore.h"
 
 namespace spaction {
 namespace automata {
 
+/// The state shared by several searches of the supremum of the same configuration automaton, run
+/// in parallel (see ParallelSupremumFinder).
+/// @remarks
+///     Every search prunes the configurations that cannot improve the best value found by any
+///     of them, and all stop as soon as one of them is done.
+struct SharedSupremum {
+    explicit SharedSupremum() : max_value(0), infinite(false), done(false) {}
+
+    /// Raises the best value found to `value`.
+    void raise(unsigned int value) {
+        unsigned int current = max_value.load(std::memory_order_relaxed);
+        while (current < value
+               and !max_value.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    /// the best value found so far
+    std::atomic<unsigned int> max_value;
+    /// whether an accepting SCC of infinite value has been found
+    std::atomic<bool> infinite;
+    /// whether a search is complete, or has found a value beyond its bound
+    std::atomic<bool> done;
+};
+
 /// a class to compute the supremum in a configuration automaton
-template<typename Q, typename S, template<typename, typename> class TS>
+/// @remarks
+///     The configuration automaton is explored through a view (see TransitionSystemView.h), whose
+///     states are MinMaxConfiguration. The view over the transition system of a
+///     MinMaxConfigurationAutomaton goes through its virtual interface, whereas a MinMaxConfigView
+///     gets the whole exploration statically dispatched.
+///     Configurations are interned in a ConfigurationStore, and the search only keeps their ids,
+///     in H, the DFS stack, the SCCs and the antichain of dead configurations. Each configuration
+///     of H is referred to until it dies, when its reference is handed over to the antichain, so
+///     that the store only keeps the live and the maximal dead configurations. A configuration is
+///     only rebuilt from the store when its component is removed.
+template<typename View>
 class SupremumFinder {
+    /// the type of the configurations
+    using state_type = typename View::state_type;
+
  public:
+    typedef ConfigurationStore<state_type> store_type;
+    typedef typename store_type::id_type id_type;
+    typedef ConfigurationAntichain<store_type> antichain_type;
+
     /// constructor
-    explicit SupremumFinder(MinMaxConfigurationAutomaton<Q, S, TS> &aut,
-                            bool poprem): _automaton(aut), _poprem(poprem), _removed_components(0) {}
+    explicit SupremumFinder(const View &view, const state_type &initial_state,
+                            std::size_t num_acceptance_sets, bool poprem)
+    : _view(view)
+    , _initial_state(initial_state)
+    , _num_acceptance_sets(num_acceptance_sets)
+    , _poprem(poprem)
+    , _removed_components(0)
+    , _pruned_configurations(0)
+    , _store(std::make_shared<store_type>(initial_state.values().size(),
+                                          initial_state.values().max_value()))
+    , _dead(std::make_shared<antichain_type>(*_store))
+    , _subsumed_configurations(0)
+    , _shared(nullptr) {}
+
+    /// Sets an upper bound on the value of the accepting runs from each configuration.
+    /// @remarks
+    ///     The bound is only used to prune the search, so that it must be sound but may be coarse.
+    ///     Without it, the only known bound of a configuration is its current value.
+    void set_upper_bound(const std::function<value_t(const state_type &)> &upper_bound) {
+        _upper_bound = upper_bound;
+    }
+
+    /// Shares the best value found with other searches, and stops when any of them is done.
+    /// @remarks    the result of find_supremum is then the one of `shared`
+    void share(SharedSupremum *shared) { _shared = shared; }
+
+    /// Interns the configurations in `store`, and keeps the dead ones in `dead`, that other
+    /// searches may use as well.
+    /// @param  dead    an antichain over `store`
+    /// @remarks
+    ///     This must be called before find_supremum. A configuration that dies in any search has
+    ///     had all its successors explored, up to pruning by the shared best value, so that the
+    ///     other searches need not explore it, nor the configurations it dominates.
+    void share_store(const std::shared_ptr<store_type> &store,
+                     const std::shared_ptr<antichain_type> &dead) {
+        _store = store;
+        _dead = dead;
+    }
+
+    /// the configurations interned by this search, and by the ones it shares its store with
+    const store_type &store() const { return *_store; }
+
+    /// the number of configurations ignored because they could not improve the supremum
+    std::size_t pruned_configurations() const { return _pruned_configurations; }
+    /// the number of configurations ignored because a dead configuration dominates them
+    std::size_t subsumed_configurations() const { return _subsumed_configurations; }
 
     /// compute the supremum by exploring the accepting SCC of the given configuration automaton
     /// by a variant of the Couvreur algorithm (FM99).
     /// A SCC in this automaton has a single value.
     /// Find the maximal value among all accepting SCC.
-    /// @todo The SCC with low values (lower than the current max) should not be explored.
+    /// The search is a branch and bound: as the value of a run can only decrease, a configuration
+    /// whose value is no greater than the best value found so far cannot lead to a better
+    /// accepting SCC, and is not explored.
+    /// Dead configurations are not kept in H: only the maximal ones are, in an antichain, and a
+    /// new configuration dominated by one of them is not explored either. A configuration
+    /// dominated by one that is still on the stack must be explored though, as it may close the
+    /// cycle of the SCC of the latter.
     /// @note   This implementation is derived from the implementation of Couvreur emptiness check
     ///         algo in spot. spot-related comments may remain in the code...
     value_t find_supremum(unsigned int bound) {
@@ -49,18 +145,22 @@ class SupremumFinder {
 
         // setup DFS from the initial state
         {
-            const MinMaxConfiguration<Q> &init = *_automaton.initial_state();
-            auto insert_res = _h.insert(std::make_pair(init, num));
+            const state_type &init = _initial_state;
+            id_type init_id = _store->intern(init);
+            auto insert_res = _h.insert(std::make_pair(init_id, num));
             assert(insert_res.second);  // ensures insertion did take place
             _root.push(scc_t(num));
-            _arc.push(std::set<std::size_t>());
-            auto itb = (*_automaton.transition_system())(init).successors().begin();
-            auto ite = (*_automaton.transition_system())(init).successors().end();
-            todo.push(state_iter(init, itb, ite));
+            _arc.push(AcceptanceSet());
+            auto succs = _view.successors(init);
+            todo.push(state_iter(init_id, succs.begin(), succs.end()));
             // inc_depth();  // for stats
         }
 
         while (!todo.empty()) {
+            // If another search is done, this one is not needed any more.
+            if (_shared and _shared->done.load(std::memory_order_relaxed))
+                return { false, max_val };
+
             //@debug
             //print_debug(std::cerr);
 
@@ -71,7 +171,7 @@ class SupremumFinder {
             // if there is no more successors, backtrack
             if (! (succ != todo.top().iter_end)) {
                 // we have explored all successors of state curr
-                MinMaxConfiguration<Q> curr = todo.top().state;
+                id_type curr = todo.top().state;
 
                 // Backtrack
                 todo.pop();
@@ -110,8 +210,9 @@ class SupremumFinder {
             // inc_transitions();  // for stats
             // Fetch the values (destination state, acceptance conditions
             // of the arc) we are interested in...
-            MinMaxConfiguration<Q> dest = (*succ)->sink();
-            std::set<std::size_t> acc = (*succ)->label().get_acceptance();
+            auto edge = *succ;
+            state_type dest = edge.sink();
+            AcceptanceSet acc = edge.label().get_acceptance();
 
             //{@logging
 //            std::cerr << " ------- " << std::endl;
@@ -128,20 +229,35 @@ class SupremumFinder {
             ++succ;
             // We do not need SUCC from now on.
 
-            // Are we going to a new state?
-            auto spit = _h.find(dest);
+            // Are we going to a new state? Only interned configurations may be in H.
+            id_type dest_id;
+            auto spit = _h.end();
+            if (_store->find(dest, dest_id))
+                spit = _h.find(dest_id);
 
             if (spit == _h.end())
             {
+                // Ignore it if it cannot improve the supremum. It is not stored, since checking its
+                // value again is cheaper.
+                if (!_may_exceed(dest, _best_value(max_val))) {
+                    ++_pruned_configurations;
+                    continue;
+                }
+                // Ignore it if it is dead, or dominated by a dead configuration.
+                if (_dead->covers(dest)) {
+                    ++_subsumed_configurations;
+                    continue;
+                }
+
                 // Yes, we are going to a new state.
                 //  Number it, stack it, and register its successors for later processing.
-                auto insert_res = _h.insert(std::make_pair(dest, ++num));
+                dest_id = _store->intern(dest);
+                auto insert_res = _h.insert(std::make_pair(dest_id, ++num));
                 assert(insert_res.second);
                 _root.push(scc_t(num));
                 _arc.push(acc);
-                auto itb = (*_automaton.transition_system())(dest).successors().begin();
-                auto ite = (*_automaton.transition_system())(dest).successors().end();
-                todo.push(state_iter(dest, itb, ite));
+                auto succs = _view.successors(dest);
+                todo.push(state_iter(dest_id, succs.begin(), succs.end()));
                 // inc_depth();  // for stats
 
                 continue;
@@ -157,14 +273,12 @@ class SupremumFinder {
 //            std::cerr << std::endl << std::endl;
             //}
 
-            // If we have reached a dead component, ignore it.
-            if (spit->second == -1)
-                continue;
-
-            // @todo A component with a value lower than the current one is not worth exploring.
-            // Consider such component as dead.
-            //            if (dest.is_bounded() and dest.current_value() <= max_val)
-            //                continue;
+            // Dead configurations are removed from H (see remove_component), so that this one is
+            // on the stack.
+            // @remarks
+            //     A component on the stack is still merged even if its value has become lower than
+            //     `max_val`, so that the SCCs popped afterwards are actual SCCs.
+            assert(spit->second != -1);
 
             // Now this is the most interesting case.  We have reached a
             // state S1 which is already part of a non-dead SCC.  Any such
@@ -178,13 +292,13 @@ class SupremumFinder {
             // top of ROOT that have an index greater to the one of
             // the SCC of S2 (called the "threshold").
             int threshold = spit->second;
-            std::list<MinMaxConfiguration<Q>> rem;
+            std::list<id_type> rem;
             while (threshold < _root.top().index)
             {
                 assert(!_root.empty());
                 assert(!_arc.empty());
-                acc.insert(_root.top().conditions.begin(), _root.top().conditions.end());
-                acc.insert(_arc.top().begin(), _arc.top().end());
+                acc |= _root.top().conditions;
+                acc |= _arc.top();
                 rem.splice(rem.end(), _root.top().rem);
                 _root.pop();
                 _arc.pop();
@@ -195,7 +309,7 @@ class SupremumFinder {
             // been merged with a lower SCC.
 
             // Accumulate all acceptance conditions into the merged SCC.
-            _root.top().conditions.insert(acc.begin(), acc.end());
+            _root.top().conditions |= acc;
             _root.top().rem.splice(_root.top().rem.end(), rem);
 
 
@@ -203,13 +317,15 @@ class SupremumFinder {
             //{@logging
 //            std::cerr << "SCC found, is it accepting?" << std::endl;
             //}
-            if (_root.top().conditions.size() == _automaton.num_acceptance_sets())
+            if (_root.top().conditions.size() == _num_acceptance_sets)
             {
 
                 // Yes, we have found an accepting SCC.
                 // use it value to update our supremum (if bounded)
                 if (dest.is_bounded()) {
                     max_val = dest.current_value() > max_val ? dest.current_value() : max_val;
+                    if (_shared)
+                        _shared->raise(max_val);
                 }
                 //{@logging
 //                std::cerr << "accepting SCC encountered, its value is " << (dest.is_bounded()?dest.current_value():-1) << std::endl;
@@ -226,20 +342,22 @@ class SupremumFinder {
                         // dec_depth();  // for stats
                     }
                     if (!dest.is_bounded())
-                        return { true, 0 };
+                        return _finish({ true, 0 });
                     else
-                        return { false, max_val };
+                        return _finish({ false, max_val });
                 }
                 // @todo    compute a lasso that witnesses newly found value
             }
         }
         // We are done exploring the configuration automaton, and a finite supremum has been found.
         assert(max_val <= bound);
-        return { false, max_val };
+        return _finish({ false, max_val });
     }
 
  private:
-    MinMaxConfigurationAutomaton<Q, S, TS> &_automaton;
+    View _view;
+    const state_type _initial_state;
+    std::size_t _num_acceptance_sets;
     bool _poprem;
 
     /// an internal struct to represent an SCC in the stack
@@ -250,45 +368,45 @@ class SupremumFinder {
         explicit scc_t(int i = -1): index(i) {}
 
         int index;
-        std::set<unsigned> conditions;
-        std::list<MinMaxConfiguration<Q>> rem;
+        AcceptanceSet conditions;
+        std::list<id_type> rem;
     };
 
     /// a pair state/iterator in the stack representing the current DFS path
     /// to test whether the iterator is done, we have to store the end iterator as well
     struct state_iter {
-        explicit state_iter(const MinMaxConfiguration<Q> &s,
-                            typename MinMaxConfigTS<Q, CounterLabel<S>, TS>::TransitionIterator i,
-                            typename MinMaxConfigTS<Q, CounterLabel<S>, TS>::TransitionIterator ie)
+        explicit state_iter(id_type s,
+                            const typename View::iterator &i,
+                            const typename View::iterator &ie)
         : state(s)
         , iter(i)
         , iter_end(ie)
         {}
 
-        MinMaxConfiguration<Q> state;
-        typename MinMaxConfigTS<Q, CounterLabel<S>, TS>::TransitionIterator iter;
-        typename MinMaxConfigTS<Q, CounterLabel<S>, TS>::TransitionIterator iter_end;
+        id_type state;
+        typename View::iterator iter;
+        typename View::iterator iter_end;
     };
 
     // a stack of SCC
     std::stack<scc_t> _root;
     // a stack of acceptance conditions between SCC
-    std::stack<std::set<std::size_t>> _arc;
-    // a hash of states
-    std::unordered_map<MinMaxConfiguration<Q>, int> _h;
+    std::stack<AcceptanceSet> _arc;
+    // a hash of states, by their id in the store
+    std::unordered_map<id_type, int> _h;
 
     // A logging function that prints the current stacks
     // @todo incorporate it properly into a logging mechanism
     void print_debug(std::ostream &os) {
         os << std::endl;
         std::stack<scc_t> root2;
-        std::stack<std::set<std::size_t>> arc2;
+        std::stack<AcceptanceSet> arc2;
         assert(_root.size() == _arc.size());
         while (!_root.empty()) {
             os << "(" << _root.top().index << " ";
             for (auto it : _h) {
                 if (it.second == _root.top().index) {
-                    _automaton.transition_system()->print_state(os, it.first);
+                    os << it.first << " ";
                 }
             }
             os << "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t|";
@@ -317,20 +435,66 @@ class SupremumFinder {
 
     unsigned _removed_components;
 
-    void remove_component(const MinMaxConfiguration<Q> &from) {
+    std::function<value_t(const state_type &)> _upper_bound;
+    std::size_t _pruned_configurations;
+
+    /// the interned configurations
+    std::shared_ptr<store_type> _store;
+
+    /// the maximal dead configurations, of this search and of the ones it shares them with
+    std::shared_ptr<antichain_type> _dead;
+    std::size_t _subsumed_configurations;
+
+    /// Moves a configuration of H to the dead ones.
+    void _kill(typename std::unordered_map<id_type, int>::iterator it) {
+        _dead->insert(it->first);
+        _h.erase(it);
+    }
+
+    SharedSupremum *_shared;
+
+    /// the best value found by this search, or by the ones it shares it with
+    unsigned int _best_value(unsigned int max_val) const {
+        if (!_shared)
+            return max_val;
+        return std::max(max_val, _shared->max_value.load(std::memory_order_relaxed));
+    }
+
+    /// Tells the searches sharing `_shared` that this one is done.
+    value_t _finish(const value_t &result) {
+        if (_shared) {
+            if (result.infinite)
+                _shared->infinite.store(true);
+            _shared->done.store(true);
+        }
+        return result;
+    }
+
+    /// whether the accepting runs from `config` may have a value greater than `max_val`
+    bool _may_exceed(const state_type &config, unsigned int max_val) const {
+        if (config.is_bounded() and config.current_value() <= max_val)
+            return false;
+        if (_upper_bound) {
+            value_t upper_bound = _upper_bound(config);
+            if (!upper_bound.infinite and upper_bound.value <= max_val)
+                return false;
+        }
+        return true;
+    }
+
+    void remove_component(id_type from) {
         ++_removed_components;
         // If rem has been updated, removing states is very easy.
         if (_poprem)
         {
             assert(!_root.top().rem.empty());
             //            dec_depth(_root.top()rem.size());  // for stats
-            typename std::list<MinMaxConfiguration<Q>>::iterator i;
+            typename std::list<id_type>::iterator i;
             for (i = _root.top().rem.begin(); i != _root.top().rem.end(); ++i)
             {
                 auto spit = _h.find(*i);
                 assert(spit != _h.end());
-                assert(spit->second != -1);
-                spit->second = -1;
+                _kill(spit);
             }
             // ecs_->root.rem().clear();
             return;
@@ -339,20 +503,7 @@ class SupremumFinder {
         // Remove from H all states which are reachable from state FROM.
 
         // Stack of iterators towards states to remove.
-        // @todo    get this struct def outside of the body of the function
-        using iterator_type = decltype((*_automaton.transition_system())(from).successors().begin());
-        struct my_iterator_pair {
-        private:
-            iterator_type _begin, _end;
-
-        public:
-            explicit my_iterator_pair(iterator_type b, iterator_type e): _begin(b), _end(e) {}
-
-            iterator_type begin() const { return _begin; }
-            iterator_type end() const { return _end; }
-        };
-        std::stack<my_iterator_pair> to_remove;
-
+        std::stack<ViewRange<typename View::iterator>> to_remove;
 
         // Remove FROM itself, and prepare to remove its successors.
         // (FROM should be in H, otherwise it means all reachable
@@ -360,41 +511,34 @@ class SupremumFinder {
         // point in calling remove_component.)
         auto spit = _h.find(from);
         assert(spit != _h.end());
-        assert(spit->second != -1);
-        spit->second = -1;
-        auto ts = _automaton.transition_system();
-        auto tmp = (*ts)(from);
-        my_iterator_pair succs(tmp.successors().begin(), tmp.successors().end());
-        
-        for (;;) {
+        // FROM is rebuilt before it is killed, since the store may free it then
+        to_remove.push(_view.successors(_store->get(from)));
+        _kill(spit);
+
+        while (!to_remove.empty()) {
+            auto succs = to_remove.top();
+            to_remove.pop();
             for (auto i : succs) {
                 //                inc_transitions();  // for stats
-                
-                MinMaxConfiguration<Q> s = i->sink();
-                auto spi = _h.find(s);
-                
-                // This state is not necessarily in H, because if we were doing inclusion checking
-                // during the emptiness-check (refining find()), the index `s' can be included in a
-                // larger state and will not be found by index(). We can safely ignore such states.
+
+                const state_type &s = i.sink();
+                id_type s_id;
+                auto spi = _h.end();
+                if (_store->find(s, s_id))
+                    spi = _h.find(s_id);
+
+                // This state is not necessarily in H: it may be dead already, or it may have been
+                // pruned, or dominated by a dead configuration. We can safely ignore such states.
                 if (spi == _h.end())
                     continue;
-                
-                if (spi->second != -1) {
-                    spi->second = -1;
-                    auto tmp = (*ts)(s);
-                    my_iterator_pair topush(tmp.successors().begin(), tmp.successors().end());
-                    to_remove.push(topush);
-                }
+
+                _kill(spi);
+                to_remove.push(_view.successors(s));
             }
-            if (to_remove.empty())
-                break;
-            
-            succs = to_remove.top();
-            to_remove.pop();
         }
     }
-    
-    
+
+
     // @note depth for stats
     int _depth;
     
@@ -409,9 +553,19 @@ class SupremumFinder {
 };
 
 template<typename Q, typename S, template<typename, typename> class TS>
-SupremumFinder<Q, S, TS>
+SupremumFinder<TransitionSystemView<MinMaxConfiguration<Q>, CounterLabel<S>>>
 make_sup_comput(MinMaxConfigurationAutomaton<Q, S, TS> &aut) {
-    return SupremumFinder<Q, S, TS>(aut, false);
+    using View = TransitionSystemView<MinMaxConfiguration<Q>, CounterLabel<S>>;
+    return SupremumFinder<View>(View(aut.transition_system()), *aut.initial_state(),
+                                aut.num_acceptance_sets(), false);
+}
+
+/// @param  view    a view whose states are MinMaxConfiguration, e.g. a MinMaxConfigView
+template<typename View>
+SupremumFinder<View>
+make_sup_comput(const View &view, const typename View::state_type &initial_state,
+                std::size_t num_acceptance_sets) {
+    return SupremumFinder<View>(view, initial_state, num_acceptance_sets, false);
 }
 
 }  // namespace automata
@@ -111,12 +111,7 @@ public:
     void print_label(std::ostream &os, const S &s) const override {
         os << "{" << bdd_format_formula(_tgba->get_dict(), s.letter()) << "}" <<  ":[";
         for (std::size_t i = 0; i < s.num_counters(); ++i) {
-            const CounterOperationList &counter = s.counter_operations(i);
-            os << "(";
-            for (auto c : counter) {
-                os << print_counter_operation(c) << ",";
-            }
-            os << "),";
+            os << "(" << print_counter_operation(s.counter_operation(i)) << ",),";
         }
         os << "]" << std::endl;
         // print acceptance conditions
@@ -218,12 +213,11 @@ private:
         }
 
         TransitionPtr<Q, S> operator*() override {
-            std::vector<CounterOperationList> op_list;
             auto tmp = _ts->_and_operands(_it->current_acceptance_conditions(), _ts->tgba_dict());
-            std::set<std::size_t> accs;
-            std::transform(tmp.begin(), tmp.end(), std::inserter(accs, accs.end()),
-                           [this](const CltlFormulaPtr &f) { return this->_ts->get_acceptance(f); });
-            CounterLabel<bdd> cl(_it->current_condition(), op_list, accs);
+            AcceptanceSet accs;
+            for (auto &f : tmp)
+                accs.insert(_ts->get_acceptance(f));
+            CounterLabel<bdd> cl(_it->current_condition(), CounterOperations(), accs);
             return TransitionPtr<Q, S>(_ts->_make_transition(_source, _it->current_state(), cl), _ts->get_control_block());
         }
 
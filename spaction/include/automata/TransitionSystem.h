@@ -18,7 +18,9 @@
 #ifndef SPACTION_INCLUDE_AUTOMATA_TRANSITIONSYSTEM_H_
 #define SPACTION_INCLUDE_AUTOMATA_TRANSITIONSYSTEM_H_
 
+#include <new>
 #include <typeinfo>
+#include <vector>
 
 #include "automata/ControlBlock.h"
 
@@ -42,7 +44,13 @@ template<typename Q, typename S> class TransitionSystem {
     typedef _StateIterator StateIterator;
 
     explicit TransitionSystem(ControlBlock<Transition<Q, S>> *cb): _control_block(cb) {}
-    virtual ~TransitionSystem() { delete _control_block; }
+    virtual ~TransitionSystem() {
+        // the control block may still release transitions, so release the storage after it
+        delete _control_block;
+        for (auto storage : _free_transitions) {
+            ::operator delete(storage);
+        }
+    }
 
     virtual void add_state(const Q &state) = 0;
     virtual void remove_state(const Q &state) = 0;
@@ -105,11 +113,12 @@ template<typename Q, typename S> class TransitionSystem {
         const Q &state() const { return _state; }
 
         SuccessorContainer successors() {
-            return SuccessorContainer(this);
+            return SuccessorContainer(*this);
         }
 
+        /// @note   \a label must outlive the returned container
         SuccessorContainer successors(const S& label) {
-            return SuccessorContainer(this, &label);
+            return SuccessorContainer(*this, &label);
         }
 
         /// @note This method is not implemented yet.
@@ -210,37 +219,40 @@ template<typename Q, typename S> class TransitionSystem {
         TransitionSystem<Q, S> *_ts;
     };
 
+    /// @remarks
+    ///     The container keeps its own copy of the state wrapper, so that it remains valid once the
+    ///     wrapper it was built from is destroyed, as in `for (auto t : (*ts)(q).successors())`.
     class RelationshipContainer {
      public:
-        explicit RelationshipContainer(StateWrapper *state_wrapper, const S* label = nullptr) :
+        explicit RelationshipContainer(const StateWrapper &state_wrapper, const S* label = nullptr) :
             _state_wrapper(state_wrapper), _label(label) { }
         virtual ~RelationshipContainer() { }
 
-        const StateWrapper *state() const { return _state_wrapper; }
+        const StateWrapper *state() const { return &_state_wrapper; }
         const S *label() const { return _label; }
 
         virtual _TransitionIterator begin() const = 0;
         virtual _TransitionIterator end() const = 0;
 
      protected:
-        StateWrapper *_state_wrapper;
+        StateWrapper _state_wrapper;
         const S *_label;
     };
 
     class SuccessorContainer : public RelationshipContainer {
      public:
-        explicit SuccessorContainer(StateWrapper *state_wrapper, const S* label = nullptr) :
+        explicit SuccessorContainer(const StateWrapper &state_wrapper, const S* label = nullptr) :
             RelationshipContainer(state_wrapper, label) { }
 
         _TransitionIterator begin() const {
-            TransitionSystem<Q, S> *ts = this->_state_wrapper->transition_system();
-            return _TransitionIterator(ts->_successor_begin(this->_state_wrapper->state(),
+            TransitionSystem<Q, S> *ts = this->_state_wrapper.transition_system();
+            return _TransitionIterator(ts->_successor_begin(this->_state_wrapper.state(),
                                                             this->_label));
         }
 
         _TransitionIterator end() const {
-            TransitionSystem<Q, S> *ts = this->_state_wrapper->transition_system();
-            return _TransitionIterator(ts->_successor_end(this->_state_wrapper->state()));
+            TransitionSystem<Q, S> *ts = this->_state_wrapper.transition_system();
+            return _TransitionIterator(ts->_successor_end(this->_state_wrapper.state()));
         }
     };
 
@@ -252,7 +264,15 @@ template<typename Q, typename S> class TransitionSystem {
     virtual Transition<Q, S> *_make_transition(const Q &source, const Q &sink, const S &label) {
         if (!has_state(source) or !has_state(sink))
             return nullptr;
-        return new Transition<Q, S>(source, sink, label);
+        // reuse the storage of a destroyed transition, if any
+        void *storage;
+        if (_free_transitions.empty()) {
+            storage = ::operator new(sizeof(Transition<Q, S>));
+        } else {
+            storage = _free_transitions.back();
+            _free_transitions.pop_back();
+        }
+        return new (storage) Transition<Q, S>(source, sink, label);
     }
     /// Internal method to destroy transitions.
     /// @remarks
@@ -261,9 +281,19 @@ template<typename Q, typename S> class TransitionSystem {
     ///     Subclasses may use this method within their implementation of `remove_transition` to
     ///     actually delete the Transition objects.
     virtual void _delete_transition(const Transition<Q, S> *t) {
-        delete t;
+        if (!t)
+            return;
+        t->~Transition();
+        _free_transitions.push_back(const_cast<Transition<Q, S>*>(t));
     }
 
+    /// The storage of the destroyed transitions, kept for reuse by `_make_transition`.
+    /// @remarks
+    ///     Transition systems that build their transitions on the fly (e.g. products) create and
+    ///     destroy one transition per explored edge. Recycling their storage makes edge traversal
+    ///     allocation-free once the number of live transitions has peaked.
+    std::vector<void*> _free_transitions;
+
     virtual TransitionBaseIterator *_successor_begin(const Q &state, const S *label) = 0;
     virtual TransitionBaseIterator *_successor_end(const Q &state) = 0;
 
@@ -313,6 +343,10 @@ bool operator==(const spaction::automata::Transition<Q, S> &lhs,
 /// A smart pointer class to handle class Transition outside of a TransitionSystem
 /// It more or less acts as a std::shared_ptr with a privileged owner. When this privileged owner
 /// goes out of scope, the pointer is destroyed, and other owners are left with dangling pointers.
+/// @remarks
+///     If the control block needs no reference counting (e.g. DumbControlBlock), the pointer holds
+///     no block at all and behaves as a raw pointer. Otherwise, blocks are recycled by the control
+///     block, so that building a TransitionPtr does not allocate in the steady state.
 /// @todo specialize std::swap, std::hash, operator<, operator==
 /// @todo use nothrow when required
 /// @todo what about thread-safety?
@@ -321,53 +355,52 @@ class TransitionPtr {
  public:
     /// @todo restrict constructor visibility?
     explicit TransitionPtr(const Transition<Q, S> *t, ControlBlock<Transition<Q, S>> *cb):
-        _data(new SmartBlock<Transition<Q, S>>(1, t, cb)) { }
+        _pointer(t), _data(cb->declare(t)) { }
 
     /// destructor
     ~TransitionPtr() {
-        if (decr()) {
-            delete _data;
-        }
+        decr();
     }
 
     /// copy semantics
-    explicit TransitionPtr(const TransitionPtr &other): _data(other._data) {
+    explicit TransitionPtr(const TransitionPtr &other): _pointer(other._pointer), _data(other._data) {
         incr();
     }
 
     TransitionPtr & operator=(const TransitionPtr &other) {
         if (this != &other) {
-            if (_data != other._data) {
-                if (decr()) {
-                    delete _data;
-                }
-            }
+            // increment first, in case both pointers share the same block
+            other.incr();
+            decr();
+            _pointer = other._pointer;
             _data = other._data;
-            incr();
         }
         return *this;
     }
 
     /// move semantics
-    TransitionPtr(TransitionPtr &&other): _data(other._data) {
+    TransitionPtr(TransitionPtr &&other): _pointer(other._pointer), _data(other._data) {
+        other._pointer = nullptr;
         other._data = nullptr;
     }
 
     TransitionPtr & operator=(TransitionPtr &&other) {
-        if (decr() and _data != other._data) {
-            delete _data;
+        if (this != &other) {
+            decr();
+            _pointer = other._pointer;
             _data = other._data;
+            other._pointer = nullptr;
+            other._data = nullptr;
         }
-        other._data = nullptr;
         return *this;
     }
 
     /// Pointer interface: dereference
-    const Transition<Q, S> &operator*() const { return *_data->_pointer; }
+    const Transition<Q, S> &operator*() const { return *_pointer; }
     /// Pointer interface: member access
-    const Transition<Q, S> *operator->() const { return _data->_pointer; }
+    const Transition<Q, S> *operator->() const { return _pointer; }
     /// Pointer interface: cast to bool
-    explicit operator bool() const { return _data->_pointer; }
+    explicit operator bool() const { return _pointer; }
 
     /// Utility functions
     std::size_t hash() const;
@@ -375,10 +408,15 @@ class TransitionPtr {
     bool operator==(const TransitionPtr &) const;
 
  private:
+    const Transition<Q, S> *_pointer;
+    /// the reference counting block, if any
     SmartBlock<Transition<Q, S>> *_data;
 
-    inline void incr() { if (_data) ++_data->_refcount; }
-    inline bool decr() { return _data and not --_data->_refcount; }
+    inline void incr() const { if (_data) ++_data->_refcount; }
+    inline void decr() {
+        if (_data and not --_data->_refcount)
+            _data->_control->release(_data);
+    }
 };
 
 }  // namespace automata
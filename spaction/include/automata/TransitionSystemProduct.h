@@ -118,6 +118,11 @@ class TransitionSystemProduct : public TransitionSystem<StateProd<Q1, Q2>, typen
         os << s;
     }
 
+    /// accessors to the operands of the product, and to the helper for label products
+    TransitionSystem<Q1, S1> *lhs() const { return _lhs; }
+    TransitionSystem<Q2, S2> *rhs() const { return _rhs; }
+    const LabelProd<S1, S2> &helper() const { return _helper; }
+
  protected:
     /// the left-hand side of the product
     TransitionSystem<Q1, S1> *_lhs;
@@ -0,0 +1,275 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_AUTOMATA_TRANSITIONSYSTEMVIEW_H_
+#define SPACTION_INCLUDE_AUTOMATA_TRANSITIONSYSTEMVIEW_H_
+
+#include <utility>
+
+#include "automata/TransitionSystem.h"
+#include "automata/UndeterministicTransitionSystem.h"
+
+namespace spaction {
+namespace automata {
+
+/// Views are a statically dispatched alternative to the successor interface of TransitionSystem.
+/// @remarks
+///     A view V provides
+///         * the types `V::state_type`, `V::label_type`, `V::edge_type` and `V::iterator`;
+///         * a method `ViewRange<V::iterator> successors(const V::state_type &) const`.
+///     `V::iterator` is a value type supporting `!=`, prefix `++` and `*`, the latter yielding a
+///     `V::edge_type` with the methods `sink()` and `label()`.
+///     Since nothing is virtual, algorithms templated on a view (see SupremumFinder) get the
+///     whole stack of views (configurations, products, ...) inlined. TransitionSystemView adapts
+///     any TransitionSystem to this interface.
+
+/// The successors of a state in a view.
+template<typename Iterator>
+class ViewRange {
+ public:
+    explicit ViewRange(const Iterator &begin, const Iterator &end): _begin(begin), _end(end) {}
+
+    const Iterator &begin() const { return _begin; }
+    const Iterator &end() const { return _end; }
+
+ private:
+    Iterator _begin, _end;
+};
+
+/// A view over any TransitionSystem, through its (virtual) successor interface.
+template<typename Q, typename S>
+class TransitionSystemView {
+ public:
+    typedef Q state_type;
+    typedef S label_type;
+
+    /// an edge keeps its transition alive
+    class edge_type {
+     public:
+        explicit edge_type(TransitionPtr<Q, S> &&t): _transition(std::move(t)) {}
+
+        const Q &sink() const { return _transition->sink(); }
+        const S &label() const { return _transition->label(); }
+
+     private:
+        TransitionPtr<Q, S> _transition;
+    };
+
+    class iterator {
+     public:
+        explicit iterator(const typename TransitionSystem<Q, S>::TransitionIterator &it): _it(it) {}
+
+        bool operator!=(const iterator &rhs) const { return _it != rhs._it; }
+        iterator &operator++() {
+            ++_it;
+            return *this;
+        }
+        edge_type operator*() const { return edge_type(*_it); }
+
+     private:
+        /// mutable, since dereferencing a TransitionIterator is not const
+        mutable typename TransitionSystem<Q, S>::TransitionIterator _it;
+    };
+
+    explicit TransitionSystemView(TransitionSystem<Q, S> *ts): _ts(ts) {}
+
+    ViewRange<iterator> successors(const Q &state) const {
+        auto wrapper = (*_ts)(state);
+        return ViewRange<iterator>(iterator(wrapper.successors().begin()),
+                                   iterator(wrapper.successors().end()));
+    }
+
+    void print_state(std::ostream &os, const Q &q) const { _ts->print_state(os, q); }
+
+ private:
+    TransitionSystem<Q, S> *_ts;
+};
+
+/// A view over a frozen UndeterministicTransitionSystem, that walks its successor arrays.
+template<typename Q, typename S>
+class FrozenView {
+    using FrozenEdge = typename UndeterministicTransitionSystem<Q, S>::FrozenEdge;
+
+ public:
+    typedef Q state_type;
+    typedef S label_type;
+
+    class edge_type {
+     public:
+        explicit edge_type(const Transition<Q, S> *t): _transition(t) {}
+
+        const Q &sink() const { return _transition->sink(); }
+        const S &label() const { return _transition->label(); }
+
+     private:
+        const Transition<Q, S> *_transition;
+    };
+
+    class iterator {
+     public:
+        explicit iterator(const FrozenEdge *it): _it(it) {}
+
+        bool operator!=(const iterator &rhs) const { return _it != rhs._it; }
+        iterator &operator++() {
+            ++_it;
+            return *this;
+        }
+        edge_type operator*() const { return edge_type(_it->transition); }
+
+     private:
+        const FrozenEdge *_it;
+    };
+
+    explicit FrozenView(const UndeterministicTransitionSystem<Q, S> *ts): _ts(ts) {
+        assert(_ts->is_frozen());
+    }
+
+    ViewRange<iterator> successors(const Q &state) const {
+        auto range = _ts->frozen_successors(_ts->state_id(state));
+        return ViewRange<iterator>(iterator(range.begin()), iterator(range.end()));
+    }
+
+    void print_state(std::ostream &os, const Q &q) const { _ts->print_state(os, q); }
+
+ private:
+    const UndeterministicTransitionSystem<Q, S> *_ts;
+};
+
+/// A view over the product of two views.
+/// @remarks
+///     `Helper` builds the product labels, and tells which ones are false, in the manner of
+///     ILabelProd.
+template<typename LhsView, typename RhsView, typename Helper>
+class ProductView {
+ public:
+    typedef std::pair<typename LhsView::state_type, typename RhsView::state_type> state_type;
+    typedef typename Helper::product_type label_type;
+
+    class edge_type {
+     public:
+        explicit edge_type(state_type sink, label_type label):
+            _sink(std::move(sink)), _label(std::move(label)) {}
+
+        const state_type &sink() const { return _sink; }
+        const label_type &label() const { return _label; }
+
+     private:
+        state_type _sink;
+        label_type _label;
+    };
+
+    class iterator {
+     public:
+        explicit iterator(const typename LhsView::iterator &l, const typename LhsView::iterator &lend,
+                          const typename RhsView::iterator &r,
+                          const typename RhsView::iterator &rbegin,
+                          const typename RhsView::iterator &rend, const Helper *helper)
+        : _lhs(l), _lend(lend), _rhs(r), _rbegin(rbegin), _rend(rend), _helper(helper) {
+            if (!(_rbegin != _rend)) {
+                _lhs = _lend;
+                _rhs = _rend;
+            }
+            if (!(_lhs != _lend)) {
+                _rhs = _rend;
+            }
+            while (!done() and conditions_invalid()) {
+                incr();
+            }
+        }
+
+        bool operator!=(const iterator &rhs) const {
+            return _lhs != rhs._lhs or _rhs != rhs._rhs;
+        }
+
+        iterator &operator++() {
+            incr();
+            while (!done() and conditions_invalid()) {
+                incr();
+            }
+            return *this;
+        }
+
+        /// @todo   the product label is built twice, once to skip the false ones, and once here
+        edge_type operator*() const {
+            auto l = *_lhs;
+            auto r = *_rhs;
+            return edge_type(state_type(l.sink(), r.sink()), _helper->build(l.label(), r.label()));
+        }
+
+     private:
+        typename LhsView::iterator _lhs, _lend;
+        typename RhsView::iterator _rhs, _rbegin, _rend;
+        const Helper *_helper;
+
+        bool done() const { return !(_lhs != _lend or _rhs != _rend); }
+
+        bool conditions_invalid() const {
+            auto l = *_lhs;
+            auto r = *_rhs;
+            return _helper->is_false(_helper->build(l.label(), r.label()));
+        }
+
+        void incr() {
+            if (++_rhs != _rend)
+                return;
+            if (++_lhs != _lend)
+                _rhs = _rbegin;
+        }
+    };
+
+    explicit ProductView(const LhsView &lhs, const RhsView &rhs, const Helper *helper):
+        _lhs(lhs), _rhs(rhs), _helper(helper) {}
+
+    ViewRange<iterator> successors(const state_type &state) const {
+        auto l = _lhs.successors(state.first);
+        auto r = _rhs.successors(state.second);
+        return ViewRange<iterator>(
+            iterator(l.begin(), l.end(), r.begin(), r.begin(), r.end(), _helper),
+            iterator(l.end(), l.end(), r.end(), r.begin(), r.end(), _helper));
+    }
+
+ private:
+    LhsView _lhs;
+    RhsView _rhs;
+    const Helper *_helper;
+};
+
+/// Factory functions for the views over transition systems.
+/// @note   the view over an UndeterministicTransitionSystem freezes it
+//@{
+template<typename Q, typename S>
+TransitionSystemView<Q, S> make_view(TransitionSystem<Q, S> *ts) {
+    return TransitionSystemView<Q, S>(ts);
+}
+
+template<typename Q, typename S>
+FrozenView<Q, S> make_view(UndeterministicTransitionSystem<Q, S> *ts) {
+    ts->freeze();
+    return FrozenView<Q, S>(ts);
+}
+
+template<typename LhsView, typename RhsView, typename Helper>
+ProductView<LhsView, RhsView, Helper>
+make_product_view(const LhsView &lhs, const RhsView &rhs, const Helper *helper) {
+    return ProductView<LhsView, RhsView, Helper>(lhs, rhs, helper);
+}
+//@}
+
+}  // namespace automata
+}  // namespace spaction
+
+#endif  // SPACTION_INCLUDE_AUTOMATA_TRANSITIONSYSTEMVIEW_H_
@@ -18,8 +18,10 @@
 #ifndef SPACTION_INCLUDE_AUTOMATA_UNDETERMINISTICTRANSITIONSYSTEM_H_
 #define SPACTION_INCLUDE_AUTOMATA_UNDETERMINISTICTRANSITIONSYSTEM_H_
 
+#include <algorithm>
 #include <cassert>
 #include <unordered_map>
+#include <vector>
 
 #include "TransitionSystem.h"
 #include "TransitionSystemPrinter.h"
@@ -29,14 +31,17 @@ namespace automata {
 
 /// A dumb ControlBlock implementation, that does nothing.
 /// The real storage is in fact the UndeterministicTransitionSystem.
+/// @remarks
+///     Since the managed objects outlive every reference to them, no reference is counted, and
+///     the pointers built upon this control block are mere raw pointers.
 template<typename T>
 class DumbControlBlock : public ControlBlock<T> {
  public:
     explicit DumbControlBlock() {}
     ~DumbControlBlock() {}
 
-    void declare(const T *) override { }
-    void release(const T *) override { }
+    SmartBlock<T> *declare(const T *) override { return nullptr; }
+    void release(SmartBlock<T> *) override { }
 };
 
 template<typename Q, typename S>
@@ -149,9 +154,74 @@ class UndeterministicTransitionSystem : public TransitionSystem<Q, S> {
         UndeterministicTransitionSystem<Q, S> *_transition_system;
     };
 
+ public:
+    /// An edge of the frozen transition system: a transition, along with the id of its sink.
+    struct FrozenEdge {
+        const Transition<Q, S> *transition;
+        unsigned int sink;
+    };
+
+    /// A contiguous range of edges of the frozen transition system.
+    class FrozenEdgeRange {
+     public:
+        explicit FrozenEdgeRange(const FrozenEdge *begin, const FrozenEdge *end) :
+            _begin(begin), _end(end) { }
+
+        const FrozenEdge *begin() const { return _begin; }
+        const FrozenEdge *end() const { return _end; }
+        std::size_t size() const { return _end - _begin; }
+        bool empty() const { return _begin == _end; }
+
+     private:
+        const FrozenEdge *_begin, *_end;
+    };
+
+ private:
+    /// Iterator over the successors of a state, once the transition system is frozen.
+    /// @remarks
+    ///     The edges of a state are grouped by label, so that the successors for a given label
+    ///     are a sub-range of the successors of the state.
+    class FrozenTransitionBaseIterator : public TransitionSystem<Q, S>::TransitionBaseIterator {
+     public:
+        explicit FrozenTransitionBaseIterator(UndeterministicTransitionSystem<Q, S> *transition_system,
+                                              const FrozenEdge *it, const FrozenEdge *stop,
+                                              const FrozenEdge *end) :
+            _it(it), _stop(stop), _end(end), _transition_system(transition_system) {
+            if (_it == _stop)
+                _it = _end;
+        }
+
+        virtual bool
+        is_equal(const typename TransitionSystem<Q, S>::TransitionBaseIterator& rhs) const {
+            const FrozenTransitionBaseIterator& bi = static_cast<const FrozenTransitionBaseIterator&>(rhs);
+            return _it == bi._it;
+        }
+
+        virtual TransitionPtr<Q, S> operator*() {
+            assert(_it != _end);
+            return TransitionPtr<Q, S>(_it->transition, _transition_system->get_control_block());
+        }
+
+        virtual const typename TransitionSystem<Q, S>::TransitionBaseIterator& operator++() {
+            // past the successors of the label, jump to the end of the successors of the state
+            if (++_it == _stop)
+                _it = _end;
+            return *this;
+        }
+
+        virtual typename TransitionSystem<Q, S>::TransitionBaseIterator *clone() const {
+            return new FrozenTransitionBaseIterator(*this);
+        }
+
+     private:
+        const FrozenEdge *_it, *_stop, *_end;
+
+        UndeterministicTransitionSystem<Q, S> *_transition_system;
+    };
+
  public:
     explicit UndeterministicTransitionSystem():
-        TransitionSystem<Q, S>(new DumbControlBlock<Transition<Q, S>>()) {}
+        TransitionSystem<Q, S>(new DumbControlBlock<Transition<Q, S>>()), _frozen(false) {}
 
     ~UndeterministicTransitionSystem() {
         for (auto &it : _graph) {
@@ -165,6 +235,7 @@ class UndeterministicTransitionSystem : public TransitionSystem<Q, S> {
 
     virtual void add_state(const Q &state) {
         if (_graph.count(state) > 0) return;
+        thaw();
         _graph[state];
     }
 
@@ -186,6 +257,7 @@ class UndeterministicTransitionSystem : public TransitionSystem<Q, S> {
         auto it = std::find_if(v.begin(), v.end(), [&t](const Transition<Q, S> *o) { return *t == *o; });
         if (it == v.end()) {
             // if the transition is not already stored, add it
+            thaw();
             v.push_back(t);
             return t;
         } else {
@@ -208,15 +280,119 @@ class UndeterministicTransitionSystem : public TransitionSystem<Q, S> {
         PrinterHelper<S>::print(os, s);
     }
 
+    /// Compacts the transition system, once its construction is over.
+    /// @remarks
+    ///     States are given dense ids, from 0 to `num_states() - 1`, and the successors of every
+    ///     state are stored contiguously (CSR layout). Successors may then be enumerated as a mere
+    ///     range of pointers, see `frozen_successors`, and the generic successor iterators walk
+    ///     that range instead of the hash maps.
+    ///     Adding a state or a transition thaws the transition system.
+    void freeze() {
+        if (_frozen) return;
+
+        // number the states
+        _frozen_states.reserve(_graph.size());
+        for (auto &it : _graph) {
+            _state_ids.emplace(it.first, _frozen_states.size());
+            _frozen_states.push_back(it.first);
+        }
+
+        // store the successors of each state contiguously, grouped by label
+        _frozen_offsets.reserve(_frozen_states.size() + 1);
+        for (auto &q : _frozen_states) {
+            _frozen_offsets.push_back(_frozen_edges.size());
+            for (auto &jt : _graph.find(q)->second) {
+                for (auto trans : jt.second) {
+                    _frozen_edges.push_back({trans, _state_ids.find(trans->sink())->second});
+                }
+            }
+        }
+        _frozen_offsets.push_back(_frozen_edges.size());
+
+        _frozen = true;
+    }
+
+    /// Drops the compact representation built by `freeze`.
+    void thaw() {
+        if (!_frozen) return;
+
+        _frozen = false;
+        _state_ids.clear();
+        _frozen_states.clear();
+        _frozen_offsets.clear();
+        _frozen_edges.clear();
+    }
+
+    bool is_frozen() const { return _frozen; }
+
+    /// @note   the following methods may only be called on a frozen transition system
+    //@{
+    std::size_t num_states() const {
+        assert(_frozen);
+        return _frozen_states.size();
+    }
+
+    unsigned int state_id(const Q &state) const {
+        assert(_frozen);
+        assert(_state_ids.count(state));
+        return _state_ids.find(state)->second;
+    }
+
+    const Q &state_of(unsigned int id) const {
+        assert(_frozen);
+        return _frozen_states[id];
+    }
+
+    FrozenEdgeRange frozen_successors(unsigned int id) const {
+        assert(_frozen);
+        const FrozenEdge *edges = _frozen_edges.data();
+        return FrozenEdgeRange(edges + _frozen_offsets[id], edges + _frozen_offsets[id + 1]);
+    }
+    //@}
+
  protected:
     std::unordered_map<Q, std::unordered_map<S, std::vector<const Transition<Q, S>*>>> _graph;
 
+    /// The compact representation of `_graph`, valid when `_frozen` holds.
+    //@{
+    bool _frozen;
+    std::unordered_map<Q, unsigned int> _state_ids;
+    std::vector<Q> _frozen_states;
+    /// the successors of the state of id `i` are the edges [_frozen_offsets[i], _frozen_offsets[i+1][
+    std::vector<std::size_t> _frozen_offsets;
+    std::vector<FrozenEdge> _frozen_edges;
+    //@}
+
     virtual typename TransitionSystem<Q, S>::TransitionBaseIterator *_successor_begin(const Q &state,
                                                                                       const S *label) {
+        if (_frozen) {
+            auto id = _state_ids.find(state);
+            if (id == _state_ids.end())
+                return new FrozenTransitionBaseIterator(this, nullptr, nullptr, nullptr);
+            auto range = frozen_successors(id->second);
+            const FrozenEdge *first = range.begin(), *last = range.end();
+            if (label) {
+                // narrow the range to the (contiguous) successors labeled with `label`
+                first = std::find_if(first, last, [label](const FrozenEdge &e) {
+                    return e.transition->label() == *label;
+                });
+                last = std::find_if(first, last, [label](const FrozenEdge &e) {
+                    return !(e.transition->label() == *label);
+                });
+            }
+            return new FrozenTransitionBaseIterator(this, first, last, range.end());
+        }
         return new TransitionBaseIterator(this, &state, label);
     }
 
     virtual typename TransitionSystem<Q, S>::TransitionBaseIterator *_successor_end(const Q &state) {
+        if (_frozen) {
+            auto id = _state_ids.find(state);
+            if (id == _state_ids.end())
+                return new FrozenTransitionBaseIterator(this, nullptr, nullptr, nullptr);
+            const FrozenEdge *end = frozen_successors(id->second).end();
+            return new FrozenTransitionBaseIterator(this, end, end, end);
+        }
         return new TransitionBaseIterator(_graph[state].end());
     }
 
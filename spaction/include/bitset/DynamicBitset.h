@@ -0,0 +1,344 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SPACTION_INCLUDE_BITSET_DYNAMICBITSET_H_
+#define SPACTION_INCLUDE_BITSET_DYNAMICBITSET_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include "hash/hash.h"
+
+namespace spaction {
+
+/// A set of bits whose size is not fixed at compile time.
+/// @remarks
+///     Bitsets of up to `kInlineWords` words are stored inline, so that the small ones (the most
+///     common case) do not allocate. The bits beyond the size of a bitset are always 0.
+///     Bitsets may also grow, and be used as vectors of packed fields, that are concatenated and
+///     sliced (see CounterOperations). Unless stated otherwise, the bitsets combined by an
+///     operation must have the same size.
+class DynamicBitset {
+ public:
+    typedef std::uint64_t word_type;
+
+    /// returned by the find methods when there is no such bit
+    enum : std::size_t { npos = static_cast<std::size_t>(-1) };
+
+    explicit DynamicBitset(std::size_t size = 0) :
+        _size(size), _capacity(std::max<std::size_t>(kInlineWords, _words_for(size))), _words(_inline) {
+        if (_capacity > kInlineWords)
+            _words = new word_type[_capacity];
+        std::memset(_words, 0, _capacity * sizeof(word_type));
+    }
+
+    DynamicBitset(const DynamicBitset &other) : DynamicBitset(other._size) {
+        std::memcpy(_words, other._words, _num_words() * sizeof(word_type));
+    }
+
+    DynamicBitset(DynamicBitset &&other) :
+        _size(other._size), _capacity(kInlineWords), _words(_inline) {
+        if (other._words != other._inline) {
+            // steal the heap storage
+            _words = other._words;
+            _capacity = other._capacity;
+            other._words = other._inline;
+            other._capacity = kInlineWords;
+            other._size = 0;
+            std::memset(other._inline, 0, sizeof(other._inline));
+        } else {
+            std::memcpy(_inline, other._inline, sizeof(_inline));
+        }
+    }
+
+    DynamicBitset &operator=(const DynamicBitset &other) {
+        if (this != &other) {
+            DynamicBitset tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    DynamicBitset &operator=(DynamicBitset &&other) {
+        if (this != &other) {
+            DynamicBitset tmp(std::move(other));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~DynamicBitset() {
+        if (_words != _inline)
+            delete[] _words;
+    }
+
+    void swap(DynamicBitset &other) {
+        // inline storages have to be copied, heap storages are exchanged
+        word_type tmp[kInlineWords];
+        std::memcpy(tmp, _inline, sizeof(_inline));
+        std::memcpy(_inline, other._inline, sizeof(_inline));
+        std::memcpy(other._inline, tmp, sizeof(_inline));
+
+        word_type *lhs = (_words == _inline) ? other._inline : _words;
+        word_type *rhs = (other._words == other._inline) ? _inline : other._words;
+        _words = rhs;
+        other._words = lhs;
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+    }
+
+    inline std::size_t size() const { return _size; }
+
+    /// Grows the bitset with 0s, or truncates it.
+    void resize(std::size_t size) {
+        std::size_t words = _words_for(size);
+        if (words > _capacity) {
+            std::size_t capacity = std::max(words, 2 * _capacity);
+            word_type *storage = new word_type[capacity];
+            std::memcpy(storage, _words, _num_words() * sizeof(word_type));
+            std::memset(storage + _num_words(), 0, (capacity - _num_words()) * sizeof(word_type));
+            if (_words != _inline)
+                delete[] _words;
+            _words = storage;
+            _capacity = capacity;
+        } else if (size < _size) {
+            // clear the truncated bits
+            std::memset(_words + words, 0, (_num_words() - words) * sizeof(word_type));
+            if (size % kWordBits)
+                _words[words - 1] &= _mask(size % kWordBits);
+        }
+        _size = size;
+    }
+
+    inline bool test(std::size_t i) const {
+        assert(i < _size);
+        return (_words[i / kWordBits] >> (i % kWordBits)) & 1;
+    }
+    inline DynamicBitset &set(std::size_t i) {
+        assert(i < _size);
+        _words[i / kWordBits] |= word_type(1) << (i % kWordBits);
+        return *this;
+    }
+    inline DynamicBitset &reset(std::size_t i) {
+        assert(i < _size);
+        _words[i / kWordBits] &= ~(word_type(1) << (i % kWordBits));
+        return *this;
+    }
+
+    /// the `width` bits from `pos`, as the lowest bits of a word
+    word_type get(std::size_t pos, std::size_t width) const {
+        assert(width != 0 and width <= kWordBits and pos + width <= _size);
+        std::size_t w = pos / kWordBits, b = pos % kWordBits;
+        word_type result = _words[w] >> b;
+        if (b != 0 and b + width > kWordBits)
+            result |= _words[w + 1] << (kWordBits - b);
+        return result & _mask(width);
+    }
+
+    /// sets the `width` bits from `pos` to the lowest bits of `value`
+    void put(std::size_t pos, std::size_t width, word_type value) {
+        assert(width != 0 and width <= kWordBits and pos + width <= _size);
+        value &= _mask(width);
+        std::size_t w = pos / kWordBits, b = pos % kWordBits;
+        _words[w] = (_words[w] & ~(_mask(width) << b)) | (value << b);
+        if (b != 0 and b + width > kWordBits) {
+            std::size_t high = b + width - kWordBits;
+            _words[w + 1] = (_words[w + 1] & ~_mask(high)) | (value >> (kWordBits - b));
+        }
+    }
+
+    /// the number of bits set
+    std::size_t count() const {
+        std::size_t result = 0;
+        for (std::size_t w = 0; w != _num_words(); ++w)
+            result += __builtin_popcountll(_words[w]);
+        return result;
+    }
+
+    /// returns true iff no bit is set
+    bool none() const {
+        for (std::size_t w = 0; w != _num_words(); ++w) {
+            if (_words[w]) return false;
+        }
+        return true;
+    }
+    inline bool any() const { return !none(); }
+
+    /// returns true iff `*this` and `other` have a set bit in common
+    bool intersects(const DynamicBitset &other) const {
+        assert(_size == other._size);
+        for (std::size_t w = 0; w != _num_words(); ++w) {
+            if (_words[w] & other._words[w]) return true;
+        }
+        return false;
+    }
+
+    /// Sets the bits set in `other`, that may be smaller than `*this`.
+    DynamicBitset &operator|=(const DynamicBitset &other) {
+        assert(other._size <= _size);
+        for (std::size_t w = 0; w != other._num_words(); ++w) {
+            _words[w] |= other._words[w];
+        }
+        return *this;
+    }
+    DynamicBitset &operator&=(const DynamicBitset &other) {
+        assert(_size == other._size);
+        for (std::size_t w = 0; w != _num_words(); ++w) {
+            _words[w] &= other._words[w];
+        }
+        return *this;
+    }
+
+    /// the index of the lowest set bit, or npos
+    inline std::size_t find_first() const { return _find_from(0); }
+    /// the index of the lowest set bit after `i`, or npos
+    inline std::size_t find_next(std::size_t i) const { return _find_from(i + 1); }
+    /// the index of the highest set bit, or npos
+    std::size_t find_last() const {
+        for (std::size_t w = _num_words(); w-- != 0;) {
+            if (_words[w])
+                return w * kWordBits + kWordBits - 1 - __builtin_clzll(_words[w]);
+        }
+        return npos;
+    }
+
+    /// returns true iff every bit set in `other`, whatever its size, is set in `*this`
+    bool includes(const DynamicBitset &other) const {
+        for (std::size_t w = 0; w != other._num_words(); ++w) {
+            word_type mine = (w < _num_words()) ? _words[w] : 0;
+            if (other._words[w] & ~mine)
+                return false;
+        }
+        return true;
+    }
+
+    /// Appends the bits of `other`, whatever its size.
+    void append(const DynamicBitset &other) {
+        if (this == &other) {
+            DynamicBitset copy(other);
+            append(copy);
+            return;
+        }
+        std::size_t offset = _size;
+        resize(_size + other._size);
+        std::size_t w0 = offset / kWordBits, b = offset % kWordBits;
+        for (std::size_t w = 0; w != other._num_words(); ++w) {
+            _words[w0 + w] |= other._words[w] << b;
+            if (b != 0 and w0 + w + 1 < _num_words())
+                _words[w0 + w + 1] |= other._words[w] >> (kWordBits - b);
+        }
+    }
+
+    /// the bits [first, last[
+    DynamicBitset slice(std::size_t first, std::size_t last) const {
+        assert(first <= last and last <= _size);
+        DynamicBitset result(last - first);
+        for (std::size_t pos = first, w = 0; pos < last; pos += kWordBits, ++w) {
+            result._words[w] = get(pos, std::min<std::size_t>(kWordBits, last - pos));
+        }
+        return result;
+    }
+
+    /// a total order on the bitsets of the same size
+    /// @return < 0, 0 or > 0 whether `*this` is lower, equal or greater than `other`
+    int compare(const DynamicBitset &other) const {
+        assert(_size == other._size);
+        for (std::size_t w = 0; w != _num_words(); ++w) {
+            if (_words[w] != other._words[w])
+                return (_words[w] < other._words[w]) ? -1 : 1;
+        }
+        return 0;
+    }
+
+    inline bool operator==(const DynamicBitset &other) const {
+        return _size == other._size and compare(other) == 0;
+    }
+    inline bool operator!=(const DynamicBitset &other) const { return !(*this == other); }
+    inline bool operator<(const DynamicBitset &other) const { return compare(other) < 0; }
+
+    std::size_t hash() const {
+        std::size_t res = _size;
+        for (std::size_t w = 0; w != _num_words(); ++w) {
+            res = hash_combine(res, hash_mix(_words[w]));
+        }
+        return res;
+    }
+
+ private:
+    enum : std::size_t { kWordBits = 64, kInlineWords = 2 };
+
+    std::size_t _size;
+    /// the number of words of the storage
+    std::size_t _capacity;
+    /// points either to `_inline` or to a heap-allocated array
+    word_type *_words;
+    word_type _inline[kInlineWords];
+
+    static inline std::size_t _words_for(std::size_t size) { return (size + kWordBits - 1) / kWordBits; }
+    inline std::size_t _num_words() const { return _words_for(_size); }
+
+    /// the word whose `width` lowest bits are set
+    static inline word_type _mask(std::size_t width) {
+        return (width == kWordBits) ? ~word_type(0) : ((word_type(1) << width) - 1);
+    }
+
+    std::size_t _find_from(std::size_t i) const {
+        if (i >= _size) return npos;
+        std::size_t w = i / kWordBits;
+        // mask out the bits below `i` in the first word
+        word_type word = _words[w] & (~word_type(0) << (i % kWordBits));
+        while (true) {
+            if (word)
+                return w * kWordBits + __builtin_ctzll(word);
+            if (++w == _num_words())
+                return npos;
+            word = _words[w];
+        }
+    }
+};
+
+inline DynamicBitset operator|(const DynamicBitset &lhs, const DynamicBitset &rhs) {
+    DynamicBitset result(lhs);
+    result |= rhs;
+    return result;
+}
+
+inline DynamicBitset operator&(const DynamicBitset &lhs, const DynamicBitset &rhs) {
+    DynamicBitset result(lhs);
+    result &= rhs;
+    return result;
+}
+
+}  // namespace spaction
+
+namespace std {
+
+template<>
+struct hash<spaction::DynamicBitset> {
+    typedef spaction::DynamicBitset argument_type;
+    typedef std::size_t result_type;
+
+    result_type operator()(const argument_type &b) const { return b.hash(); }
+};
+
+}  // namespace std
+
+#endif  // SPACTION_INCLUDE_BITSET_DYNAMICBITSET_H_
@@ -20,11 +20,16 @@
 
 #include <string>
 #include "CltlFormula.h"
+#include "CltlFormulaFactory.h"
 
 namespace spaction {
 namespace cltlparse {
 
+/// Parses a formula, built by a static default factory.
 CltlFormulaPtr parse_formula(const std::string &ltl_string);
+/// Parses a formula, built by `factory`.
+/// @remarks    the formula must not outlive `factory`
+CltlFormulaPtr parse_formula(const std::string &ltl_string, CltlFormulaFactory &factory);
 
 }  // namespace cltlparse
 }  // namespace spaction
@@ -18,27 +18,57 @@
 #ifndef SPACTION_INCLUDE_HASH_HASH_H_
 #define SPACTION_INCLUDE_HASH_HASH_H_
 
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
 #include <vector>
 
+namespace spaction {
+
+/// Combines `value` into the hash `seed`.
+/// @remarks
+///     hash combination and magic numbers are taken from Boost `hash_combine_impl`
+inline std::size_t hash_combine(std::size_t seed, std::size_t value) {
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+/// Scrambles the bits of `value`, so that close values get unrelated hashes.
+/// @remarks
+///     `std::hash` is the identity on integers and pointers, and `hash_combine` alone lets the
+///     low bits of combined small values collide. This is the finalizer of MurmurHash3.
+inline std::size_t hash_mix(std::uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return static_cast<std::size_t>(value);
+}
+
+/// Combines the hashes of the elements of [first, last[ into `seed`, in order.
+template<typename Iterator,
+         typename Hash = std::hash<typename std::iterator_traits<Iterator>::value_type>>
+std::size_t hash_range(std::size_t seed, Iterator first, Iterator last, Hash h = Hash()) {
+    for (; first != last; ++first)
+        seed = hash_combine(seed, h(*first));
+    return seed;
+}
+
+}  // namespace spaction
+
 namespace std {
 
-/// hash combination and magic numbers are taken from Boost `hash_combine_impl`
 template<typename S>
 struct hash<std::vector<S>> {
     typedef std::vector<S> argument_type;
     typedef std::size_t result_type;
 
     result_type operator()(const argument_type &v) const {
-        hash<S> h;
-        result_type res = 0;
-        for (auto s : v) {
-            res ^= h(s) + 0x9e3779b9 + (res << 6) + (res >> 2);
-        }
-        return res;
+        return spaction::hash_mix(spaction::hash_range(v.size(), v.begin(), v.end()));
     }
 };
 
-/// hash combination and magic numbers are taken from Boost `hash_combine_impl`
 template<typename A, typename B>
 struct hash<std::pair<A,B>> {
     typedef std::pair<A,B> argument_type;
@@ -47,10 +77,7 @@ struct hash<std::pair<A,B>> {
     result_type operator()(const argument_type &p) const {
         hash<A> ha;
         hash<B> hb;
-        result_type res = 0;
-        res ^= ha(p.first) + 0x9e3779b9 + (res << 6) + (res >> 2);
-        res ^= hb(p.second) + 0x9e3779b9 + (res << 6) + (res >> 2);
-        return res;
+        return spaction::hash_combine(spaction::hash_combine(0, ha(p.first)), hb(p.second));
     }
 };
 
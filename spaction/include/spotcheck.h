@@ -20,13 +20,61 @@
 
 #include <string>
 
+#include <spot/kripke/kripke.hh>
+#include <spot/ltlvisit/apcollect.hh>
 #include <spot/tgba/tgba.hh>
+#include <spot/tgbaalgos/emptiness.hh>
 
 #include "CltlFormula.h"
 #include "automata/TGBA2CA.h"
 
 namespace spaction {
 
+/// A session to run several checks against a same DVE model.
+/// @remarks
+///     The model is loaded once, along with its bdd dictionary, and its state space is explored
+///     once and kept as an explicit automaton. Every check then only builds the property side
+///     (translation of the formula and product), and reuses the model as is.
+class BoundSearchSession {
+ public:
+    /// loads the model from `modelfile`, observing the atomic propositions `aps`
+    explicit BoundSearchSession(const std::string &modelfile,
+                                const spot::ltl::atomic_prop_set &aps);
+    /// loads the model from `modelfile`, observing the atomic propositions of `formula`
+    explicit BoundSearchSession(const std::string &modelfile, const CltlFormulaPtr &formula);
+    ~BoundSearchSession();
+
+    /// Copy construction is forbidden.
+    BoundSearchSession(const BoundSearchSession &) = delete;
+    /// Copy assignment is forbidden.
+    BoundSearchSession &operator=(const BoundSearchSession &) = delete;
+
+    /// uses spot to check a LTL formula against the model
+    /// @remarks
+    ///     the LTL formula is tested as is. It is the responsibility of the user to negate the
+    ///     formula if necessary. Its atomic propositions must have been given to the session.
+    /// @return     true iff \a formula holds on no execution of the model (empty product)
+    bool check(const spot::ltl::formula *formula);
+
+    /// the bdd dictionary shared by the model and the property automata
+    spot::bdd_dict *dict() const { return _dict; }
+    /// the model, whose state space is explicit
+    const spot::tgba *model() const { return _explicit_model; }
+    /// the number of reachable states of the model
+    unsigned int model_size() const { return _model_size; }
+    /// the emptiness check instantiator used by the session
+    const spot::emptiness_check_instantiator *emptiness_check() const { return _echeck_inst; }
+
+ private:
+    spot::bdd_dict *_dict;
+    /// the model, as loaded from the DVE file
+    spot::kripke *_model;
+    /// an explicit copy of `_model`, so that its state space is only computed once
+    const spot::tgba *_explicit_model;
+    unsigned int _model_size;
+    spot::emptiness_check_instantiator *_echeck_inst;
+};
+
 // @todo expose it?
 // uses spot to check a LTL formula against a DVE model
 // @remarks
@@ -39,23 +87,32 @@ bool spot_dve_check(const std::string &formula, const std::string &modelfile);
 
 enum class BoundSearchStrategy {
     CEGAR,
-    DIRECT
+    DIRECT,
+    /// dichotomic search over bounded-counter automata (see BoundedCounterAutomaton)
+    BOUNDED
 };
 
 /// finds the min bound of the given formula over the given model
 /// in practice, uses CLTL[<=] formulae
+/// @note       only a dichotomic search over instantiated formulae is available, whatever \a strat
 /// @param      a CLTL[<=] formula
 /// @param      the path to the DVE model which \a formula is tested against
+/// @param      the number of probes to run in parallel, each in its own process
 /// @return     \inf \a formula (u)  for u accepted by the DVE model
 unsigned int find_bound_min(const CltlFormulaPtr &formula, const std::string &modelname,
-                            BoundSearchStrategy strat);
+                            BoundSearchStrategy strat, unsigned int jobs = 1);
 /// finds the min bound of the given formula over the given model
 /// in practice, uses CLTL[>] formulae
 /// @param      a CLTL[>] formula
 /// @param      the path to the DVE model which \a formula is tested against
+/// @param      the number of jobs: with the BOUNDED strategy, the number of probes of the
+///             dichotomic search to run in parallel, each in its own process; with the DIRECT
+///             strategy, the number of threads searching the supremum over the product, made
+///             explicit first (see ParallelSupremumFinder), and translating a top-level
+///             conjunction; unused by the CEGAR strategy
 /// @return     \sup \a formula (u)  for u accepted by the DVE model
 unsigned int find_bound_max(const CltlFormulaPtr &formula, const std::string &modelname,
-                            BoundSearchStrategy strat);
+                            BoundSearchStrategy strat, unsigned int jobs = 1);
 
 /// loads a LTL formula as a CA, through spot
 /// @todo currently unused, should we keep it?
@@ -16,20 +16,32 @@
 // limitations under the License.
 
 #include "AtomicProposition.h"
+
+#include <functional>
+
 #include "CltlFormulaVisitor.h"
+#include "hash/hash.h"
 
 namespace spaction {
 
 AtomicProposition::AtomicProposition(const std::string &value, CltlFormulaFactory *creator) :
-    CltlFormula(creator), _value(value) {
+    CltlFormula(creator, _make_hash(value)), _value(value) {
 }
 
-bool AtomicProposition::syntactic_eq(const CltlFormula &rhs) const {
-    if (rhs.formula_type() != CltlFormula::kAtomicProposition)
+std::size_t AtomicProposition::_make_hash(const std::string &value) {
+    return hash_combine(CltlFormula::kAtomicProposition, std::hash<std::string>()(value));
+}
+
+bool AtomicProposition::_is_same(const CltlFormula &formula, const std::string &value) {
+    if (formula.formula_type() != CltlFormula::kAtomicProposition)
         return false;
 
-    const AtomicProposition &ap = static_cast<const AtomicProposition &>(rhs);
-    return ap._value == _value;
+    const AtomicProposition &ap = static_cast<const AtomicProposition &>(formula);
+    return ap._value == value;
+}
+
+bool AtomicProposition::syntactic_eq(const CltlFormula &rhs) const {
+    return _is_same(rhs, _value);
 }
 
 void AtomicProposition::accept(CltlFormulaVisitor &visitor) {
@@ -17,156 +17,112 @@
 
 #include "BinaryOperator.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <stack>
 
 #include "CltlFormulaFactory.h"
 #include "CltlFormulaVisitor.h"
+#include "hash/hash.h"
 
 namespace spaction {
 
 BinaryOperator::BinaryOperator(BinaryOperatorType type, const CltlFormulaPtr &left,
                                const CltlFormulaPtr &right, CltlFormulaFactory *creator) :
-    CltlFormula(creator), _type(type), _left(left), _right(right) {
+    CltlFormula(creator, _make_hash(type, left, right)), _type(type), _left(left), _right(right) {
+    _height = 1 + std::max(left->height(), right->height());
+    _is_infltl = (type != kCostRelease) and left->is_infltl() and right->is_infltl();
+    _is_supltl = (type != kCostUntil) and left->is_supltl() and right->is_supltl();
+    _is_propositional = (type == kOr or type == kAnd)
+                     and left->is_propositional() and right->is_propositional();
+    _is_nnf = left->is_nnf() and right->is_nnf();
 }
 
-bool BinaryOperator::syntactic_eq(const CltlFormula &rhs) const {
-    if (rhs.formula_type() != CltlFormula::kBinaryOperator)
+std::size_t BinaryOperator::_make_hash(BinaryOperatorType type, const CltlFormulaPtr &left,
+                                       const CltlFormulaPtr &right) {
+    const std::size_t seed = hash_combine(CltlFormula::kBinaryOperator, type);
+
+    switch (type) {
+        case BinaryOperator::kOr:
+        case BinaryOperator::kAnd: {
+            // sum the contributions of the leaves, so the result does not depend on their order;
+            // an operand of the same type already holds the sum of its own leaves
+            auto contribution = [type, seed](const CltlFormulaPtr &operand) -> std::size_t {
+                if (operand->formula_type() == CltlFormula::kBinaryOperator and
+                    static_cast<BinaryOperator*>(operand.get())->_type == type) {
+                    return operand->hash() - seed;
+                }
+                return hash_combine(seed, operand->hash());
+            };
+            return seed + contribution(left) + contribution(right);
+        }
+        case BinaryOperator::kUntil:
+        case BinaryOperator::kRelease:
+        case BinaryOperator::kCostUntil:
+        case BinaryOperator::kCostRelease:
+            return hash_combine(hash_combine(seed, left->hash()), right->hash());
+    }
+}
+
+bool BinaryOperator::_is_same(const CltlFormula &formula, BinaryOperatorType type,
+                              const CltlFormulaPtr &left, const CltlFormulaPtr &right) {
+    if (formula.formula_type() != CltlFormula::kBinaryOperator)
         return false;
 
-    const BinaryOperator &bo = static_cast<const BinaryOperator &>(rhs);
-    if (bo._type != _type)
+    const BinaryOperator &bo = static_cast<const BinaryOperator &>(formula);
+    if (bo._type != type)
         return false;
 
-    switch (bo.operator_type()) {
+    switch (type) {
         case BinaryOperator::kOr:
         case BinaryOperator::kAnd:
-            return _leaves() == bo._leaves();
+            return bo._leaves() == _leaves(type, left.get(), right.get());
         case BinaryOperator::kUntil:
         case BinaryOperator::kRelease:
         case BinaryOperator::kCostUntil:
         case BinaryOperator::kCostRelease:
-            return ((bo._left == _left) and (bo._right == _right));
+            return ((bo._left == left) and (bo._right == right));
     }
 }
 
+bool BinaryOperator::syntactic_eq(const CltlFormula &rhs) const {
+    return _is_same(rhs, _type, _left, _right);
+}
+
 CltlFormulaPtr BinaryOperator::to_nnf() {
-    return _creator->make_binary(_type, _left->to_nnf(), _right->to_nnf());
+    return _creator->make_nnf(shared_from_this());
 }
 
 CltlFormulaPtr BinaryOperator::to_dnf() {
-    // get the negative normal form of itself
-    CltlFormulaPtr &&nnf_self = this->to_nnf();
-
-    // check if `nnf_self` is a binary operator
-    if (nnf_self->formula_type() == CltlFormula::kBinaryOperator) {
-        // recursively transform operands
-        BinaryOperator *bo_self = static_cast<BinaryOperator*>(nnf_self.get());
-        const CltlFormulaPtr &left = bo_self->left()->to_dnf();
-        const CltlFormulaPtr &right = bo_self->right()->to_dnf();
-
-        // check if `nnf_self` is of the form (x && y)
-        if (bo_self->operator_type() == BinaryOperator::kAnd) {
-            if (right->formula_type() == CltlFormula::kBinaryOperator) {
-                BinaryOperator *bo_right = static_cast<BinaryOperator*>(right.get());
-                if (bo_right->operator_type() == BinaryOperator::kOr) {
-                    // distribute a * (b + c)
-                    const CltlFormulaPtr &a = _creator->make_and(left, bo_right->left());
-                    const CltlFormulaPtr &b = _creator->make_and(left, bo_right->right());
-                    return _creator->make_or(a, b)->to_dnf();
-                }
-            } else if (left->formula_type() == CltlFormula::kBinaryOperator) {
-                BinaryOperator *bo_left = static_cast<BinaryOperator*>(left.get());
-                if (bo_left->operator_type() == BinaryOperator::kOr) {
-                    // distribute (a + b) * c
-                    const CltlFormulaPtr &a = _creator->make_and(right, bo_left->left());
-                    const CltlFormulaPtr &b = _creator->make_and(right, bo_left->right());
-                    return _creator->make_or(a, b)->to_dnf();
-                }
-            }
-        } else {
-            // returns a binary operator with transformed operands
-            return _creator->make_binary(bo_self->operator_type(), left, right);
-        }
-    }
-
-    // no further transformation to be performed since `nnf_self` is not a binary operator
-    return nnf_self;
+    return _creator->make_dnf(shared_from_this());
 }
 
-std::unordered_multiset<const CltlFormula*> BinaryOperator::_leaves() const {
+std::unordered_multiset<const CltlFormula*> BinaryOperator::_leaves(BinaryOperatorType type,
+                                                                    const CltlFormula *left,
+                                                                    const CltlFormula *right) {
     std::unordered_multiset<const CltlFormula*> leaves;
-    std::stack<const BinaryOperator*> stack({this});
-    bool is_leaf;
+    std::stack<const CltlFormula*> stack({left, right});
 
     // unfold the operator such that we get the set of leaves
     while (!stack.empty()) {
-        const BinaryOperator *current = stack.top();
+        const CltlFormula *current = stack.top();
         stack.pop();
 
-        // push the right member on the stack, unless it is not a compatible operation
-        is_leaf = true;
-        if (current->right()->formula_type() == CltlFormula::kBinaryOperator) {
-            BinaryOperator *bo = static_cast<BinaryOperator*>(current->right().get());
-            if (bo->operator_type() == _type) {
-                stack.push(bo);
-                is_leaf = false;
-            }
-        }
-        if (is_leaf) {
-            leaves.insert(current->right().get());
-        }
-
-        // push the left member on the stack, unless it is not a compatible operation
-        is_leaf = true;
-        if (current->left()->formula_type() == CltlFormula::kBinaryOperator) {
-            BinaryOperator *bo = static_cast<BinaryOperator*>(current->left().get());
-            if (bo->operator_type() == _type) {
-                stack.push(bo);
-                is_leaf = false;
+        // push the members of a compatible operation on the stack, otherwise it is a leaf
+        if (current->formula_type() == CltlFormula::kBinaryOperator) {
+            const BinaryOperator *bo = static_cast<const BinaryOperator*>(current);
+            if (bo->operator_type() == type) {
+                stack.push(bo->right().get());
+                stack.push(bo->left().get());
+                continue;
             }
         }
-        if (is_leaf) {
-            leaves.insert(current->left().get());
-        }
+        leaves.insert(current);
     }
 
     return leaves;
 }
 
-bool BinaryOperator::is_infltl() const {
-    if (_type == kCostRelease) {
-        return false;
-    } else {
-        return _left->is_infltl() and _right->is_infltl();
-    }
-}
-
-bool BinaryOperator::is_supltl() const {
-    if (_type == kCostUntil) {
-        return false;
-    } else {
-        return _left->is_supltl() and _right->is_supltl();
-    }
-}
-
-bool BinaryOperator::is_propositional() const {
-    switch (_type) {
-        case BinaryOperator::kUntil:
-        case BinaryOperator::kRelease:
-        case BinaryOperator::kCostUntil:
-        case BinaryOperator::kCostRelease:
-            return false;
-        case BinaryOperator::kOr:
-        case BinaryOperator::kAnd:
-            return _left->is_propositional() and _right->is_propositional();
-    }
-}
-
-bool BinaryOperator::is_nnf() const {
-    return _left->is_nnf() and _right->is_nnf();
-}
-
 void BinaryOperator::accept(CltlFormulaVisitor &visitor) {
     // explicitly cast shared_from_this to the a derived class shared_ptr
     visitor.visit(std::dynamic_pointer_cast<BinaryOperator>(shared_from_this()));
@@ -27,69 +27,104 @@
 
 namespace spaction {
 
-CltlFormulaPtr CltlFormulaFactory::_make_shared_formula(CltlFormula *formula) {
+CltlFormulaFactory::CltlFormulaFactory(AllocationPolicy policy) {
+    if (policy == kArenaAllocation) {
+        _arena.reset(new SlabArena());
+    }
+}
+
+CltlFormulaFactory::~CltlFormulaFactory() {
+    // the weak references of the index may share the control blocks of the arena
+    _formulae.clear();
+    // release the formulae of the arena, the most recent first so that every formula is destroyed
+    // before its operands
+    while (!_arena_formulae.empty()) {
+        CltlFormula *formula = _arena_formulae.back().get();
+        _arena_formulae.pop_back();
+        formula->~CltlFormula();
+    }
+}
+
+template<typename T, typename... Args>
+CltlFormulaPtr CltlFormulaFactory::_make_shared_formula(const Args &...args) {
+    const std::size_t hash = T::_make_hash(args...);
+    std::lock_guard<std::mutex> lock(_index_mutex);
+
     // try to find the formula within the unique index and return its shared pointer
-    for (auto f : _formulae) {
-        if (f->syntactic_eq(*formula)) return f->shared_from_this();
+    auto range = _formulae.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (!T::_is_same(*it->second.formula, args...)) continue;
+        // the formula may have been released by another thread, whose deleter waits for the lock
+        if (CltlFormulaPtr result = it->second.reference.lock()) return result;
     }
 
     // insert the new formula in the unique index and creates its shared pointer
-    _formulae.insert(formula);
-    return CltlFormulaPtr(formula, std::bind(&CltlFormulaFactory::_deleter, this,
-                                             std::placeholders::_1));
+    CltlFormulaPtr result;
+    if (_arena) {
+        // both the formula and the control block of its shared pointer live in the arena
+        T *formula = new (_arena->allocate(sizeof(T), alignof(T))) T(args..., this);
+        result = CltlFormulaPtr(formula, _ArenaDeleter(), ArenaAllocator<CltlFormula>(*_arena));
+        _arena_formulae.push_back(result);
+    } else {
+        T *formula = new T(args..., this);
+        result = CltlFormulaPtr(formula, std::bind(&CltlFormulaFactory::_deleter, this,
+                                                   std::placeholders::_1));
+    }
+    _formulae.emplace(hash, _IndexEntry{result.get(), result});
+    return result;
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_atomic(const std::string &value) {
-    return _make_shared_formula(new AtomicProposition(value, this));
+    return _make_shared_formula<AtomicProposition>(value);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_constant(bool value) {
-    return _make_shared_formula(new ConstantExpression(value, this));
+    return _make_shared_formula<ConstantExpression>(value);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_unary(UnaryOperator::UnaryOperatorType operator_type,
                                               const CltlFormulaPtr &formula) {
-    return _make_shared_formula(new UnaryOperator(operator_type, formula, this));
+    return _make_shared_formula<UnaryOperator>(operator_type, formula);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_next(const CltlFormulaPtr &f) {
-    return _make_shared_formula(new UnaryOperator(UnaryOperator::kNext, f, this));
+    return _make_shared_formula<UnaryOperator>(UnaryOperator::kNext, f);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_not(const CltlFormulaPtr &f) {
-    return _make_shared_formula(new UnaryOperator(UnaryOperator::kNot, f, this));
+    return _make_shared_formula<UnaryOperator>(UnaryOperator::kNot, f);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_binary(BinaryOperator::BinaryOperatorType operator_type,
                                                const CltlFormulaPtr &left,
                                                const CltlFormulaPtr &right) {
-    return _make_shared_formula(new BinaryOperator(operator_type, left, right, this));
+    return _make_shared_formula<BinaryOperator>(operator_type, left, right);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_or(const CltlFormulaPtr &l, const CltlFormulaPtr &r) {
-    return _make_shared_formula(new BinaryOperator(BinaryOperator::kOr, l, r, this));
+    return _make_shared_formula<BinaryOperator>(BinaryOperator::kOr, l, r);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_and(const CltlFormulaPtr &l, const CltlFormulaPtr &r) {
-    return _make_shared_formula(new BinaryOperator(BinaryOperator::kAnd, l, r, this));
+    return _make_shared_formula<BinaryOperator>(BinaryOperator::kAnd, l, r);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_until(const CltlFormulaPtr &l, const CltlFormulaPtr &r) {
-    return _make_shared_formula(new BinaryOperator(BinaryOperator::kUntil, l, r, this));
+    return _make_shared_formula<BinaryOperator>(BinaryOperator::kUntil, l, r);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_release(const CltlFormulaPtr &l, const CltlFormulaPtr &r) {
-    return _make_shared_formula(new BinaryOperator(BinaryOperator::kRelease, l, r, this));
+    return _make_shared_formula<BinaryOperator>(BinaryOperator::kRelease, l, r);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_costuntil(const CltlFormulaPtr &l,
                                               const CltlFormulaPtr &r) {
-    return _make_shared_formula(new BinaryOperator(BinaryOperator::kCostUntil, l, r, this));
+    return _make_shared_formula<BinaryOperator>(BinaryOperator::kCostUntil, l, r);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_costrelease(const CltlFormulaPtr &l,
                                                 const CltlFormulaPtr &r) {
-    return _make_shared_formula(new BinaryOperator(BinaryOperator::kCostRelease, l, r, this));
+    return _make_shared_formula<BinaryOperator>(BinaryOperator::kCostRelease, l, r);
 }
 
 CltlFormulaPtr CltlFormulaFactory::make_imply(const CltlFormulaPtr &l, const CltlFormulaPtr &r) {
@@ -119,4 +154,147 @@ CltlFormulaPtr CltlFormulaFactory::make_costglobally(const CltlFormulaPtr &f) {
     return make_costrelease(ftrue, f);
 }
 
+CltlFormulaPtr CltlFormulaFactory::make_nnf(const CltlFormulaPtr &formula) {
+    if (formula->is_nnf())
+        return formula;
+
+    std::lock_guard<std::recursive_mutex> lock(_normal_forms_mutex);
+    auto it = _normal_forms.find(formula.get());
+    if (it != _normal_forms.end()) {
+        if (CltlFormulaPtr result = it->second.nnf.lock()) return result;
+    }
+
+    CltlFormulaPtr result;
+    switch (formula->formula_type()) {
+        case CltlFormula::kUnaryOperator: {
+            UnaryOperator *uo = static_cast<UnaryOperator*>(formula.get());
+            if (uo->operator_type() == UnaryOperator::kNot) {
+                // push the negation to the leaves
+                result = _make_negated_nnf(uo->operand());
+            } else {
+                result = make_next(make_nnf(uo->operand()));
+            }
+            break;
+        }
+        case CltlFormula::kBinaryOperator: {
+            BinaryOperator *bo = static_cast<BinaryOperator*>(formula.get());
+            result = make_binary(bo->operator_type(), make_nnf(bo->left()), make_nnf(bo->right()));
+            break;
+        }
+        case CltlFormula::kAtomicProposition:
+        case CltlFormula::kConstantExpression:
+            result = formula;
+            break;
+    }
+
+    // the recursive calls may have invalidated `it`
+    _normal_forms[formula.get()].nnf = result;
+    return result;
+}
+
+CltlFormulaPtr CltlFormulaFactory::_make_negated_nnf(const CltlFormulaPtr &formula) {
+    std::lock_guard<std::recursive_mutex> lock(_normal_forms_mutex);
+    auto it = _normal_forms.find(formula.get());
+    if (it != _normal_forms.end()) {
+        if (CltlFormulaPtr result = it->second.negated_nnf.lock()) return result;
+    }
+
+    CltlFormulaPtr result;
+    switch (formula->formula_type()) {
+        case CltlFormula::kUnaryOperator: {
+            UnaryOperator *uo = static_cast<UnaryOperator*>(formula.get());
+            if (uo->operator_type() == UnaryOperator::kNot) {
+                // two NOTs cancel out
+                result = make_nnf(uo->operand());
+            } else {
+                result = make_next(_make_negated_nnf(uo->operand()));
+            }
+            break;
+        }
+        case CltlFormula::kBinaryOperator: {
+            // apply the dual operator to the negated operands
+            BinaryOperator *bo = static_cast<BinaryOperator*>(formula.get());
+            const CltlFormulaPtr &left = _make_negated_nnf(bo->left());
+            const CltlFormulaPtr &right = _make_negated_nnf(bo->right());
+            switch (bo->operator_type()) {
+                case BinaryOperator::kOr:
+                    result = make_and(left, right);
+                    break;
+                case BinaryOperator::kAnd:
+                    result = make_or(left, right);
+                    break;
+                case BinaryOperator::kUntil:
+                    result = make_release(left, right);
+                    break;
+                case BinaryOperator::kRelease:
+                    result = make_until(left, right);
+                    break;
+                case BinaryOperator::kCostUntil:
+                    result = make_costrelease(left, right);
+                    break;
+                case BinaryOperator::kCostRelease:
+                    result = make_costuntil(left, right);
+                    break;
+            }
+            break;
+        }
+        case CltlFormula::kAtomicProposition:
+        case CltlFormula::kConstantExpression:
+            result = make_not(formula);
+            break;
+    }
+
+    _normal_forms[formula.get()].negated_nnf = result;
+    return result;
+}
+
+CltlFormulaPtr CltlFormulaFactory::make_dnf(const CltlFormulaPtr &formula) {
+    std::lock_guard<std::recursive_mutex> lock(_normal_forms_mutex);
+    auto it = _normal_forms.find(formula.get());
+    if (it != _normal_forms.end()) {
+        if (CltlFormulaPtr result = it->second.dnf.lock()) return result;
+    }
+
+    CltlFormulaPtr result;
+    const CltlFormulaPtr &nnf = make_nnf(formula);
+    if (nnf != formula) {
+        // the disjunctive normal form is computed on the negation normal form
+        result = make_dnf(nnf);
+    } else if (formula->formula_type() == CltlFormula::kBinaryOperator) {
+        // recursively transform operands
+        BinaryOperator *bo = static_cast<BinaryOperator*>(formula.get());
+        const CltlFormulaPtr &left = make_dnf(bo->left());
+        const CltlFormulaPtr &right = make_dnf(bo->right());
+
+        auto is_or = [](const CltlFormulaPtr &f) {
+            return f->formula_type() == CltlFormula::kBinaryOperator
+               and static_cast<BinaryOperator*>(f.get())->operator_type() == BinaryOperator::kOr;
+        };
+
+        if (bo->operator_type() != BinaryOperator::kAnd) {
+            result = make_binary(bo->operator_type(), left, right);
+        } else if (is_or(right)) {
+            // distribute a * (b + c)
+            BinaryOperator *bo_right = static_cast<BinaryOperator*>(right.get());
+            const CltlFormulaPtr &a = make_dnf(make_and(left, bo_right->left()));
+            const CltlFormulaPtr &b = make_dnf(make_and(left, bo_right->right()));
+            result = make_or(a, b);
+        } else if (is_or(left)) {
+            // distribute (a + b) * c
+            BinaryOperator *bo_left = static_cast<BinaryOperator*>(left.get());
+            const CltlFormulaPtr &a = make_dnf(make_and(right, bo_left->left()));
+            const CltlFormulaPtr &b = make_dnf(make_and(right, bo_left->right()));
+            result = make_or(a, b);
+        } else {
+            result = make_and(left, right);
+        }
+    } else {
+        // no further transformation to be performed since `formula` is not a binary operator
+        result = formula;
+    }
+
+    _normal_forms[formula.get()].dnf = result;
+    return result;
+}
+
 }  // namespace spaction
@@ -17,19 +17,28 @@
 
 #include "ConstantExpression.h"
 #include "CltlFormulaVisitor.h"
+#include "hash/hash.h"
 
 namespace spaction {
 
 ConstantExpression::ConstantExpression(bool value, CltlFormulaFactory *creator) :
-    CltlFormula(creator), _value(value) {
+    CltlFormula(creator, _make_hash(value)), _value(value) {
 }
 
-bool ConstantExpression::syntactic_eq(const CltlFormula &rhs) const {
-    if (rhs.formula_type() != CltlFormula::kConstantExpression)
+std::size_t ConstantExpression::_make_hash(bool value) {
+    return hash_combine(CltlFormula::kConstantExpression, value);
+}
+
+bool ConstantExpression::_is_same(const CltlFormula &formula, bool value) {
+    if (formula.formula_type() != CltlFormula::kConstantExpression)
         return false;
 
-    const ConstantExpression &ce = static_cast<const ConstantExpression &>(rhs);
-    return ce._value == _value;
+    const ConstantExpression &ce = static_cast<const ConstantExpression &>(formula);
+    return ce._value == value;
+}
+
+bool ConstantExpression::syntactic_eq(const CltlFormula &rhs) const {
+    return _is_same(rhs, _value);
 }
 
 void ConstantExpression::accept(CltlFormulaVisitor &visitor) {
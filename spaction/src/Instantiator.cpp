@@ -30,8 +30,25 @@ namespace spaction {
 
 CltlFormulaPtr Instantiator::operator()(const CltlFormulaPtr &formula, unsigned int n) {
     _preprocess(formula, n);
+    return _instantiate(formula, n);
+}
+
+CltlFormulaPtr Instantiator::_instantiate(const CltlFormulaPtr &formula, unsigned int n) {
+    // LTL formulae are left unchanged by the instantiation, whatever n
+    if (formula->is_ltl())
+        return formula;
+
+    const std::pair<CltlFormulaPtr, unsigned int> key(formula, n);
+    auto it = _cache.find(key);
+    if (it != _cache.end())
+        return it->second;
+
+    const unsigned int previous_n = _n;
     _n = n;
     formula->accept(*this);
+    _n = previous_n;
+
+    _cache.emplace(key, _result);
     return _result;
 }
 
@@ -45,20 +62,15 @@ void Instantiator::visit(const std::shared_ptr<ConstantExpression> &formula) {
 }
 
 void Instantiator::visit(const std::shared_ptr<UnaryOperator> &formula) {
-    // use a copy of the current instantiator to instantiate operand
-    Instantiator *instantiator = this->copy();
-    const CltlFormulaPtr &operand = (*instantiator)(formula->operand(), _n);
-    delete instantiator;
+    const CltlFormulaPtr &operand = _instantiate(formula->operand(), _n);
 
     CltlFormulaFactory *factory = formula->creator();
     _result = factory->make_unary(formula->operator_type(), operand);
 }
 
 void Instantiator::visit(const std::shared_ptr<BinaryOperator> &formula) {
-    // use a copy of the current instantiator to instantiate operands
-    Instantiator *instantiator = this->copy();
-    const CltlFormulaPtr &left = (*instantiator)(formula->left(), _n);
-    const CltlFormulaPtr &right = (*instantiator)(formula->right(), _n);
+    const CltlFormulaPtr &left = _instantiate(formula->left(), _n);
+    const CltlFormulaPtr &right = _instantiate(formula->right(), _n);
     CltlFormulaFactory *factory = formula->creator();
 
     switch (formula->operator_type()) {
@@ -71,23 +83,19 @@ void Instantiator::visit(const std::shared_ptr<BinaryOperator> &formula) {
             break;
         case BinaryOperator::kCostUntil:
             // (f UN g)[n] = (f[n] UN g[n])[n]
-            _result = _rewrite_cost_until(formula, left, right, instantiator);
+            _result = _rewrite_cost_until(formula, left, right);
             break;
         case BinaryOperator::kCostRelease:
             // (f RN g)[n] = (f[n] RN g[n])[n]
-            _result = _rewrite_cost_release(formula, left, right, instantiator);
+            _result = _rewrite_cost_release(formula, left, right);
             break;
     }
-
-    delete instantiator;
-
 }
 
 // recall that left and right are assumed to be LTL (already instantiated)
 CltlFormulaPtr InstantiateInf::_rewrite_cost_until(const CltlFormulaPtr &formula,
                                                    const CltlFormulaPtr &left,
-                                                   const CltlFormulaPtr &right,
-                                                   Instantiator *instantiator) const {
+                                                   const CltlFormulaPtr &right) {
     // the formula factory
     CltlFormulaFactory *factory = formula->creator();
 
@@ -104,7 +112,7 @@ CltlFormulaPtr InstantiateInf::_rewrite_cost_until(const CltlFormulaPtr &formula
     //          more complicated, but it might produce more deterministic automata
 
     // recursive call formula[n-1]
-    const CltlFormulaPtr &rec_formula = (*instantiator)(formula, _n-1);
+    const CltlFormulaPtr &rec_formula = _instantiate(formula, _n-1);
     // X(formula[n-1])
     const CltlFormulaPtr &next_rec_formula = factory->make_next(rec_formula);
     // left || X(formula[n-1])
@@ -115,8 +123,7 @@ CltlFormulaPtr InstantiateInf::_rewrite_cost_until(const CltlFormulaPtr &formula
 
 CltlFormulaPtr InstantiateInf::_rewrite_cost_release(const CltlFormulaPtr &formula,
                                                      const CltlFormulaPtr &left,
-                                                     const CltlFormulaPtr &right,
-                                                     Instantiator *instantiator) const {
+                                                     const CltlFormulaPtr &right) {
     throw std::domain_error("Cost Release encountered: inf instantiation should be applied to CLTL[<=] formulae only");
 }
 
@@ -127,15 +134,13 @@ void InstantiateInf::_preprocess(const CltlFormulaPtr &formula, unsigned int n)
 
 CltlFormulaPtr InstantiateSup::_rewrite_cost_until(const CltlFormulaPtr &formula,
                                                    const CltlFormulaPtr &left,
-                                                   const CltlFormulaPtr &right,
-                                                   Instantiator *instantiator) const {
+                                                   const CltlFormulaPtr &right) {
     throw std::domain_error("Cost Until encountered: sup instantiation should be applied to CLTL[>] formulae only");
 }
 
 CltlFormulaPtr InstantiateSup::_rewrite_cost_release(const CltlFormulaPtr &formula,
                                                      const CltlFormulaPtr &left,
-                                                     const CltlFormulaPtr &right,
-                                                     spaction::Instantiator *instantiator) const {
+                                                     const CltlFormulaPtr &right) {
     // the formula factory
     CltlFormulaFactory *factory = formula->creator();
 
@@ -149,7 +154,7 @@ CltlFormulaPtr InstantiateSup::_rewrite_cost_release(const CltlFormulaPtr &formu
     // (f RN g)[n] = (f && X(f RN g)[n-1]) R g
 
     // recursive call formula[n-1]
-    const CltlFormulaPtr &rec_formula = (*instantiator)(formula, _n-1);
+    const CltlFormulaPtr &rec_formula = _instantiate(formula, _n-1);
     // X(formula[n-1])
     const CltlFormulaPtr &next_rec_formula = factory->make_next(rec_formula);
     // left && X(formula[n-1])
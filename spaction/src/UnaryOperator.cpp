@@ -20,93 +20,52 @@
 #include "BinaryOperator.h"
 #include "CltlFormulaFactory.h"
 #include "CltlFormulaVisitor.h"
+#include "hash/hash.h"
 
 namespace spaction {
 
 UnaryOperator::UnaryOperator(UnaryOperatorType type, const CltlFormulaPtr &operand,
                              CltlFormulaFactory *creator) :
-    CltlFormula(creator), _type(type), _operand(operand) {
+    CltlFormula(creator, _make_hash(type, operand)), _type(type), _operand(operand) {
+    _height = 1 + operand->height();
+
+    if (type == kNot) {
+        _is_infltl = operand->is_supltl();
+        _is_supltl = operand->is_infltl();
+        _is_propositional = operand->is_propositional();
+        _is_nnf = operand->formula_type() == CltlFormula::kAtomicProposition
+               or operand->formula_type() == CltlFormula::kConstantExpression;
+    } else {
+        _is_infltl = operand->is_infltl();
+        _is_supltl = operand->is_supltl();
+        _is_propositional = false;
+        _is_nnf = operand->is_nnf();
+    }
 }
 
-bool UnaryOperator::syntactic_eq(const CltlFormula &rhs) const {
-    if (rhs.formula_type() != CltlFormula::kUnaryOperator)
-        return false;
-
-    const UnaryOperator &uo = static_cast<const UnaryOperator &>(rhs);
-    return (uo._type == _type) and (uo._operand == _operand);
+std::size_t UnaryOperator::_make_hash(UnaryOperatorType type, const CltlFormulaPtr &operand) {
+    return hash_combine(hash_combine(CltlFormula::kUnaryOperator, type), operand->hash());
 }
 
-CltlFormulaPtr UnaryOperator::to_nnf() {
-    // if the top-level operator is NOT, push it to the leaves
-    if (_type == UnaryOperator::kNot) {
-        // if the operand is itself a unary operation
-        if (_operand->formula_type() == CltlFormula::kUnaryOperator) {
-            UnaryOperator *uo = static_cast<UnaryOperator*>(_operand.get());
-            // two NOTs cancel out
-            if (uo->operator_type() == UnaryOperator::kNot) {
-                return uo->operand()->to_nnf();
-            } else {
-                return _creator->make_next(_creator->make_not(uo->operand())->to_nnf());
-            }
-        }
-
-        // if the operand is a binary operation
-        if (_operand->formula_type() == CltlFormula::kBinaryOperator) {
-            BinaryOperator *bo = static_cast<BinaryOperator*>(_operand.get());
-            switch (bo->operator_type()) {
-                case BinaryOperator::kOr:
-                    return _creator->make_and(bo->left(), bo->right())->to_nnf();
-                case BinaryOperator::kAnd:
-                    return _creator->make_or(bo->left(), bo->right())->to_nnf();
-                case BinaryOperator::kUntil:
-                    return _creator->make_release(bo->left(), bo->right())->to_nnf();
-                case BinaryOperator::kRelease:
-                    return _creator->make_until(bo->left(), bo->right())->to_nnf();
-                case BinaryOperator::kCostUntil:
-                    return _creator->make_costrelease(bo->left(), bo->right())->to_nnf();
-                case BinaryOperator::kCostRelease:
-                    return _creator->make_costuntil(bo->left(), bo->right())->to_nnf();
-            }
-        }
-
-        // in any other cases (i.e. Constant and Atomic Proposition)
-        return _creator->make_not(_operand);
-    }
-
-    // if the top-level operator is NEXT, just recursive call
-    return _creator->make_next(_operand->to_nnf());
-}
+bool UnaryOperator::_is_same(const CltlFormula &formula, UnaryOperatorType type,
+                             const CltlFormulaPtr &operand) {
+    if (formula.formula_type() != CltlFormula::kUnaryOperator)
+        return false;
 
-bool UnaryOperator::is_infltl() const {
-    if (_type == kNot) {
-        return _operand->is_supltl();
-    } else {
-        return _operand->is_infltl();
-    }
+    const UnaryOperator &uo = static_cast<const UnaryOperator &>(formula);
+    return (uo._type == type) and (uo._operand == operand);
 }
 
-bool UnaryOperator::is_supltl() const {
-    if (_type == kNot) {
-        return _operand->is_infltl();
-    } else {
-        return _operand->is_supltl();
-    }
+bool UnaryOperator::syntactic_eq(const CltlFormula &rhs) const {
+    return _is_same(rhs, _type, _operand);
 }
 
-bool UnaryOperator::is_propositional() const {
-    if (_type == kNext)
-        return false;
-    else
-        return _operand->is_propositional();
+CltlFormulaPtr UnaryOperator::to_nnf() {
+    return _creator->make_nnf(shared_from_this());
 }
 
-bool UnaryOperator::is_nnf() const {
-    if (_type == kNot) {
-        return _operand->formula_type() == CltlFormula::kAtomicProposition
-            or _operand->formula_type() == CltlFormula::kConstantExpression;
-    } else {
-        return _operand->is_nnf();
-    }
+CltlFormulaPtr UnaryOperator::to_dnf() {
+    return _creator->make_dnf(shared_from_this());
 }
 
 void UnaryOperator::accept(CltlFormulaVisitor &visitor) {
@@ -31,12 +31,32 @@ CltlTranslator::CltlTranslator(const CltlFormulaPtr &formula) :
     _formula(formula->to_nnf()), _nb_acceptances(0), _nb_counters(0) {
         assert(_formula->is_nnf());
         this->map_costop_to_counters(_formula);
+        _closure.build(_formula);
         _automaton = CounterAutomaton<Node*, FormulaList, UndeterministicTransitionSystem>(_nb_counters, _nb_acceptances);
 }
 
 void CltlTranslator::build_automaton() {
     _build_transition_system();
+    // the epsilon transition system is complete, compact it before walking it
+    _transition_system.freeze();
     _build_automaton();
+    _automaton.transition_system()->freeze();
+}
+
+void CltlTranslator::build_lazy_automaton() {
+    _lazy_automaton = lazy_automaton_type(_nb_counters, _nb_acceptances);
+
+    // the initial state
+    Node *initial_node = _build_node(_closure.make({_formula}));
+    _lazy_automaton.transition_system()->add_state(initial_node);
+    _lazy_automaton.set_initial_state(initial_node);
+
+    // the transitions from a state are built when they are first requested
+    _lazy_automaton.transition_system()->set_expander(
+        [this](LazyTransitionSystem<Node*, CounterLabel<FormulaList>> &ts, Node *const &s) {
+            this->_build_successors(s);
+            this->_remove_epsilon(s, &ts);
+        });
 }
 
 void CltlTranslator::map_costop_to_counters(const CltlFormulaPtr &f) {
@@ -79,48 +99,106 @@ std::function<bool (const CltlFormulaPtr &, const CltlFormulaPtr &)>
         };
     }
 
-CltlTranslator::FormulaList CltlTranslator::_unique_sort(const CltlTranslator::FormulaList &terms) {
-    FormulaList result(terms);
-    // sort
-    std::sort(result.begin(), result.end(), get_formula_order());
-    // remove duplicates
-    auto last = std::unique(result.begin(), result.end());
-    // remove shrinked values
-    result.erase(last, result.end());
+void CltlTranslator::Closure::build(const CltlFormulaPtr &formula) {
+    // collect the subformulae, and the X(f) for the (cost) Until and Release f
+    std::unordered_set<CltlFormulaPtr> collected;
+    std::stack<CltlFormulaPtr> to_visit;
+    to_visit.push(formula);
+    while (!to_visit.empty()) {
+        CltlFormulaPtr f = to_visit.top();
+        to_visit.pop();
+        if (!collected.insert(f).second)
+            continue;
+
+        if (f->formula_type() == CltlFormula::kUnaryOperator) {
+            to_visit.push(static_cast<UnaryOperator*>(f.get())->operand());
+        } else if (f->formula_type() == CltlFormula::kBinaryOperator) {
+            BinaryOperator *bo = static_cast<BinaryOperator*>(f.get());
+            to_visit.push(bo->left());
+            to_visit.push(bo->right());
+            if (bo->operator_type() != BinaryOperator::kOr and bo->operator_type() != BinaryOperator::kAnd)
+                to_visit.push(bo->creator()->make_next(f));
+        }
+    }
+
+    // index them by height, so that the nodes are sorted as their former lists of terms
+    formulae.assign(collected.begin(), collected.end());
+    std::sort(formulae.begin(), formulae.end(), get_formula_order());
+
+    const std::size_t size = formulae.size();
+    binary_operators = DynamicBitset(size);
+    false_constants = DynamicBitset(size);
+    negations = DynamicBitset(size);
+    negated_operand.assign(size, DynamicBitset::npos);
+    next_operand.assign(size, DynamicBitset::npos);
+    next_formula.assign(size, DynamicBitset::npos);
+    for (std::size_t i = 0; i != size; ++i) {
+        index[formulae[i].get()] = i;
+    }
+    for (std::size_t i = 0; i != size; ++i) {
+        const CltlFormulaPtr &f = formulae[i];
+        switch (f->formula_type()) {
+            case CltlFormula::kBinaryOperator:
+                binary_operators.set(i);
+                break;
+            case CltlFormula::kConstantExpression:
+                if (!static_cast<ConstantExpression*>(f.get())->value())
+                    false_constants.set(i);
+                break;
+            case CltlFormula::kUnaryOperator: {
+                UnaryOperator *uo = static_cast<UnaryOperator*>(f.get());
+                if (uo->operator_type() == UnaryOperator::kNot) {
+                    negations.set(i);
+                    negated_operand[i] = index.at(uo->operand().get());
+                } else {
+                    next_operand[i] = index.at(uo->operand().get());
+                    next_formula[next_operand[i]] = i;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+DynamicBitset CltlTranslator::Closure::make(const FormulaList &terms) const {
+    DynamicBitset result(formulae.size());
+    for (auto f : terms) {
+        assert(index.count(f.get()));
+        result.set(index.at(f.get()));
+    }
     return result;
 }
 
-CltlTranslator::Node *CltlTranslator::_build_node(const FormulaList &terms) {
-    FormulaList canonical = _unique_sort(terms);
+CltlTranslator::Node *CltlTranslator::_build_node(const DynamicBitset &terms) {
     // search for a pre-existing instance of the node
-    for (auto n : _nodes) {
-        if (n->terms() == canonical) return n;
-    }
+    auto it = _nodes_index.find(terms);
+    if (it != _nodes_index.end())
+        return it->second;
 
     // build a new instance and stores its pointer
-    Node *n = new Node(canonical);
+    Node *n = new Node(terms, &_closure);
 
     if (n->is_consistent())
         _transition_system.add_state(n);
     _nodes.push_back(n);
+    _nodes_index.emplace(n->bits(), n);
     return n;
 }
 
 CltlTranslator::NodeList CltlTranslator::_build_epsilon_successors(Node *node) {
     // take the formula with the highest height out of the subset to be reduced
-    CltlFormulaPtr f = 0;
-    FormulaList leftover(node->terms());
-
-    for (long i = node->terms().size() - 1; i >= 0; --i) {
-        // only binary operators must be reduced
-        if (node->terms()[i]->formula_type() == CltlFormula::kBinaryOperator) {
-            f = node->terms()[i];
-            leftover.erase(leftover.begin() + i);
-            break;
-        }
-    }
+    // only binary operators must be reduced
+    DynamicBitset leftover(node->bits());
+    std::size_t i = (leftover & _closure.binary_operators).find_last();
+    if (i == DynamicBitset::npos) return {};
 
-    if (!f) return {};
+    const CltlFormulaPtr &f = _closure.formulae[i];
+    leftover.reset(i);
+    // X(f), that the closure holds for the temporal operators
+    const CltlFormulaPtr &next_f = (_closure.next_formula[i] != DynamicBitset::npos)
+                                 ? _closure.formulae[_closure.next_formula[i]] : f;
 
     BinaryOperator *bo = static_cast<BinaryOperator*>(f.get());
     NodeList successors;
@@ -164,7 +242,7 @@ CltlTranslator::NodeList CltlTranslator::_build_epsilon_successors(Node *node) {
                 successors.push_back(s0);
             }
 
-            Node *s1 = _build_node(_insert(leftover, {bo->left(), bo->creator()->make_next(f)}));
+            Node *s1 = _build_node(_insert(leftover, {bo->left(), next_f}));
             if (s1->is_consistent()) {
                 _transition_system.add_transition(node, s1, new TransitionLabel({}, CounterOperationList(_nb_counters), f));
                 successors.push_back(s1);
@@ -182,7 +260,7 @@ CltlTranslator::NodeList CltlTranslator::_build_epsilon_successors(Node *node) {
                 successors.push_back(s0);
             }
 
-            Node *s1 = _build_node(_insert(leftover, {bo->right(), bo->creator()->make_next(f)}));
+            Node *s1 = _build_node(_insert(leftover, {bo->right(), next_f}));
             if (s1->is_consistent()) {
                 _transition_system.add_transition(node, s1, new TransitionLabel({}, CounterOperationList(_nb_counters)));
                 successors.push_back(s1);
@@ -205,14 +283,14 @@ CltlTranslator::NodeList CltlTranslator::_build_epsilon_successors(Node *node) {
                 successors.push_back(s0);
             }
 
-            Node *s1 = _build_node(_insert(leftover, {bo->left(), bo->creator()->make_next(f)}));
+            Node *s1 = _build_node(_insert(leftover, {bo->left(), next_f}));
             if (s1->is_consistent()) {
                 counters[current_counter] = _e();
                 _transition_system.add_transition(node, s1, new TransitionLabel({}, counters, f));
                 successors.push_back(s1);
             }
 
-            Node *s2 = _build_node(_insert(leftover, {bo->creator()->make_next(f)}));
+            Node *s2 = _build_node(_insert(leftover, {next_f}));
             if (s2->is_consistent()) {
                 counters[current_counter] = _ic();
                 _transition_system.add_transition(node, s2, new TransitionLabel({}, counters, f));
@@ -236,14 +314,14 @@ CltlTranslator::NodeList CltlTranslator::_build_epsilon_successors(Node *node) {
                 successors.push_back(s0);
             }
 
-            Node *s1 = _build_node(_insert(leftover, {bo->right(), bo->creator()->make_next(f)}));
+            Node *s1 = _build_node(_insert(leftover, {bo->right(), next_f}));
             if (s1->is_consistent()) {
                 counters[current_counter] = _e();
                 _transition_system.add_transition(node, s1, new TransitionLabel({}, counters));
                 successors.push_back(s1);
             }
 
-            Node *s2 = _build_node(_insert(leftover, {bo->left(), bo->right(), bo->creator()->make_next(f)}));
+            Node *s2 = _build_node(_insert(leftover, {bo->left(), bo->right(), next_f}));
             if (s2->is_consistent()) {
                 counters[current_counter] = _i();
                 _transition_system.add_transition(node, s2, new TransitionLabel({}, counters));
@@ -257,20 +335,18 @@ CltlTranslator::NodeList CltlTranslator::_build_epsilon_successors(Node *node) {
 
 CltlTranslator::Node *CltlTranslator::_build_actual_successor(Node *node) {
     FormulaList propositions;
-    FormulaList successor_terms;
+    DynamicBitset successor_terms(_closure.formulae.size());
 
-    for (auto f : node->terms()) {
+    const DynamicBitset &terms = node->bits();
+    for (std::size_t i = terms.find_first(); i != DynamicBitset::npos; i = terms.find_next(i)) {
         // formulae of type f = X(f1) will be transformed to f1 in the successor
-        if (f->formula_type() == CltlFormula::kUnaryOperator) {
-            UnaryOperator *uo = static_cast<UnaryOperator*>(f.get());
-            if (uo->operator_type() == UnaryOperator::kNext) {
-                successor_terms.push_back(uo->operand());
-                continue;
-            }
+        if (_closure.next_operand[i] != DynamicBitset::npos) {
+            successor_terms.set(_closure.next_operand[i]);
+            continue;
         }
 
         // reduced non-next formulae must be satisfied to move to the successor
-        propositions.push_back(f);
+        propositions.push_back(_closure.formulae[i]);
     }
 
     Node *suc = _build_node(successor_terms);
@@ -279,8 +355,8 @@ CltlTranslator::Node *CltlTranslator::_build_actual_successor(Node *node) {
 }
 
 void CltlTranslator::_build_transition_system() {
-    _to_be_reduced.push(_build_node({_formula}));
-    _states.push_back(_build_node({_formula}));
+    _to_be_reduced.push(_build_node(_closure.make({_formula})));
+    _states.insert(_build_node(_closure.make({_formula})));
 
     while (!(_to_be_reduced.empty() and _to_be_fired.empty())) {
         _process_reduce();
@@ -318,16 +394,38 @@ void CltlTranslator::_process_fire() {
 
         // build the actual successor of `s`
         Node *t = _build_actual_successor(s);
-        if (std::find(_states.begin(), _states.end(), t) == _states.end())
-            _states.push_back(t);
+        _states.insert(t);
 
         _to_be_reduced.push(t);
     }
 }
 
+void CltlTranslator::_build_successors(Node *node) {
+    if (node->is_processed())
+        return;
+    node->set_processed();
+
+    // a node without epsilon-successors is fired
+    if (_build_epsilon_successors(node).empty())
+        _build_actual_successor(node);
+}
+
+template<typename F>
+void CltlTranslator::_for_each_successor(Node *node, F f) {
+    if (_transition_system.is_frozen()) {
+        for (auto &edge : _transition_system.frozen_successors(_transition_system.state_id(node))) {
+            f(edge.transition);
+        }
+    } else {
+        for (auto t : _transition_system(node).successors()) {
+            f(&*t);
+        }
+    }
+}
+
 void CltlTranslator::_build_automaton() {
     // the initial state
-    Node *initial_node = _build_node({_formula});
+    Node *initial_node = _build_node(_closure.make({_formula}));
     _automaton.transition_system()->add_state(initial_node);
     _automaton.set_initial_state(initial_node);
 
@@ -341,130 +439,165 @@ void CltlTranslator::_process_remove_epsilon() {
     // fetch the next state to be processed
     Node *s = _to_remove_epsilon.top();
     _to_remove_epsilon.pop();
+    if (!_done_remove_epsilon.insert(s).second)
+        return;
 
-    // on fait un parcours en profondeur depuis 's'
-    // on coupe une branche dès qu'on atteint un état réduit
-    _process_remove_epsilon(s, s, {});
-    _done_remove_epsilon.insert(s);
+    for (auto t : _remove_epsilon(s, _automaton.transition_system())) {
+        if (_done_remove_epsilon.count(t) == 0) {
+            _to_remove_epsilon.push(t);
+        }
+    }
 }
 
-void CltlTranslator::_process_remove_epsilon(Node *source, Node *s,
-                                             const std::vector<TransitionLabel*> &trace) {
-    // base case
-    if (s->is_reduced()) {
-        for (auto succ : _transition_system(s).successors()) {
-            std::vector<TransitionLabel*> new_trace = trace;
-            new_trace.push_back(succ->label());
-            _add_nonepsilon_transition(source, succ->sink(), new_trace);
-            if (_done_remove_epsilon.count(succ->sink()) == 0) {
-                _to_remove_epsilon.push(succ->sink());
-            }
+CltlTranslator::NodeList CltlTranslator::_remove_epsilon(Node *source,
+                                                         automaton_type::transition_system_t *ts) {
+    // the reduced nodes epsilon-reachable from 'source' have a single actual transition each, that
+    // is prefixed with each epsilon-path leading to them
+    NodeList sinks;
+    for (const auto &summary : _epsilon_closure(source)) {
+        _for_each_successor(summary.target, [&](const Transition<Node*, TransitionLabel*> *succ) {
+            _add_nonepsilon_transition(ts, source, succ->sink(), summary, succ->label());
+            sinks.push_back(succ->sink());
+        });
+    }
+    return sinks;
+}
+
+const std::vector<CltlTranslator::EpsilonSummary> &CltlTranslator::_epsilon_closure(Node *node) {
+    auto it = _epsilon_closures.find(node);
+    if (it != _epsilon_closures.end())
+        return it->second;
+
+    // post-order traversal of the epsilon-transitions, which form a DAG as each of them reduces the
+    // biggest formula of its source
+    std::stack<Node*> to_visit;
+    to_visit.push(node);
+    while (!to_visit.empty()) {
+        Node *n = to_visit.top();
+        if (_epsilon_closures.count(n) != 0) {
+            to_visit.pop();
+            continue;
         }
-        return;
+
+        // when translating on the fly, the temporary transition system is built as it is walked
+        _build_successors(n);
+
+        // base case
+        if (n->is_reduced()) {
+            _epsilon_closures[n].push_back(EpsilonSummary(n, _nb_counters));
+            to_visit.pop();
+            continue;
+        }
+
+        // the closure of 'n' is built from the closures of its successors, once they are known
+        bool ready = true;
+        _for_each_successor(n, [&](const Transition<Node*, TransitionLabel*> *succ) {
+            if (_epsilon_closures.count(succ->sink()) == 0) {
+                to_visit.push(succ->sink());
+                ready = false;
+            }
+        });
+        if (!ready)
+            continue;
+        to_visit.pop();
+
+        std::vector<EpsilonSummary> closure;
+        _for_each_successor(n, [&](const Transition<Node*, TransitionLabel*> *succ) {
+            // only the actual transitions have propositions
+            assert(succ->label()->propositions.empty());
+            for (auto summary : _epsilon_closures[succ->sink()]) {
+                _append_to_summary(summary, succ->label());
+                // equivalent paths yield the same transitions
+                if (std::find(closure.begin(), closure.end(), summary) == closure.end())
+                    closure.push_back(std::move(summary));
+            }
+        });
+        _epsilon_closures.emplace(n, std::move(closure));
     }
 
-    // recursive case
-    for (auto succ : _transition_system(s).successors()) {
-        std::vector<TransitionLabel*> new_trace = trace;
-        new_trace.push_back(succ->label());
-        _process_remove_epsilon(source, succ->sink(), new_trace);
+    return _epsilon_closures[node];
+}
+
+void CltlTranslator::_append_to_summary(EpsilonSummary &summary, const TransitionLabel *label) const {
+    assert(label->counter_actions.size() == _nb_counters);
+    for (std::size_t i = 0 ; i != _nb_counters ; ++i) {
+        // there should not be several actions on the same counter along a single trace
+        assert(!(summary.counter_actions[i] and label->counter_actions[i]));
+
+        summary.counter_actions[i] = (summary.counter_actions[i] | label->counter_actions[i]);
     }
+
+    auto it = _acceptances_maps.find(label->postponed);
+    if (it != _acceptances_maps.end())
+        summary.postponed.insert(it->second);
 }
 
-void CltlTranslator::_add_nonepsilon_transition(Node *source, Node *sink,
-                                                const std::vector<TransitionLabel*> &trace) {
+void CltlTranslator::_add_nonepsilon_transition(automaton_type::transition_system_t *ts,
+                                                Node *source, Node *sink,
+                                                const EpsilonSummary &summary,
+                                                const TransitionLabel *label) {
     // add source and sink to the transition system
-    _automaton.transition_system()->add_state(source);
-    _automaton.transition_system()->add_state(sink);
+    ts->add_state(source);
+    ts->add_state(sink);
 
     // build counter actions
-    CounterOperationList counter_actions(_nb_counters);
-    for (auto t : trace) {
-        assert(t->counter_actions.size() == _nb_counters);
-        for (std::size_t i = 0 ; i != _nb_counters ; ++i) {
-            // there should not be several actions on the same counter along a single trace
-            assert(!(counter_actions[i] and t->counter_actions[i]));
-
-            counter_actions[i] = (counter_actions[i] | t->counter_actions[i]);
-        }
-    }
+    EpsilonSummary trace(summary);
+    _append_to_summary(trace, label);
 
     // build label
-    // only the last element should have a proposition (thank you, lambda functions)
-    assert([&trace](void) {
-        auto it = std::find_if(trace.begin(), trace.end(),
-                               [](TransitionLabel *t) { return !(t->propositions.empty()); });
-        return (it == trace.end()) or (++it == trace.end()); } ());
-
-    auto it = std::find_if(trace.begin(), trace.end(),
-                           [](TransitionLabel *t) { return !(t->propositions.empty()); } );
-    FormulaList props;
-    if (it != trace.end())
-        props = (*it)->propositions;
-    // remove 'true'
-    if (!props.empty()) {
-        auto fc = (*props.begin())->creator();
-        FormulaList::const_iterator jt;
-        while ((jt = std::find(props.begin(), props.end(), fc->make_constant(true))) != props.end()) {
-            props.erase(jt);
-        }
-    }
+    FormulaList props = label->propositions;
+    // remove 'true', without building it in the factory
+    props.erase(std::remove_if(props.begin(), props.end(), [](const CltlFormulaPtr &f) {
+                    return f->formula_type() == CltlFormula::kConstantExpression
+                       and static_cast<ConstantExpression*>(f.get())->value();
+                }), props.end());
 
     // build acceptance conditions
-    std::set<std::size_t> accs;
-    // @TODO using std::generate would be better
+    AcceptanceSet accs;
     for (std::size_t i = 0 ; i != _nb_acceptances ; ++i) {
-        accs.insert(i);
-    }
-    for (auto t : trace) {
-        auto it = _acceptances_maps.find(t->postponed);
-        if (it != _acceptances_maps.end())
-            accs.erase(it->second);
+        if (trace.postponed.count(i) == 0)
+            accs.insert(i);
     }
 
     // add into the automaton
-    std::vector<CounterOperationList> tmp(_nb_counters);
-    std::transform(counter_actions.begin(), counter_actions.end(), tmp.begin(), [](CounterOperation c) -> CounterOperationList { return {c}; });
-    _automaton.transition_system()->add_transition(source, sink,
-                                                   _automaton.make_label(props, tmp, accs));
+    CounterOperations ops(_nb_counters);
+    for (std::size_t k = 0; k != trace.counter_actions.size(); ++k)
+        ops.set(k, trace.counter_actions[k]);
+    ts->add_transition(source, sink, CounterLabel<FormulaList>(props, ops, accs));
 }
 
-CltlTranslator::FormulaList CltlTranslator::_insert(const FormulaList &list,
-                                                    const std::initializer_list<CltlFormulaPtr> &add_list) const {
-    FormulaList result(list);
-    result.insert(result.end(), add_list);
+DynamicBitset CltlTranslator::_insert(const DynamicBitset &terms,
+                                      const std::initializer_list<CltlFormulaPtr> &add_list) const {
+    DynamicBitset result(terms);
+    for (auto f : add_list) {
+        assert(_closure.index.count(f.get()));
+        result.set(_closure.index.at(f.get()));
+    }
+    return result;
+}
+
+CltlTranslator::FormulaList CltlTranslator::Node::terms() const {
+    FormulaList result;
+    for (std::size_t i = _terms.find_first(); i != DynamicBitset::npos; i = _terms.find_next(i)) {
+        result.push_back(_closure->formulae[i]);
+    }
     return result;
 }
 
 bool CltlTranslator::Node::is_reduced() const {
     // reduced = atoms or X
     // therefore, non-reduced <=> binaryop
-    return std::find_if(_terms.begin(), _terms.end(),
-                        [](CltlFormulaPtr f){ return f->formula_type() == CltlFormula::kBinaryOperator; })
-        == _terms.end();
+    return !_terms.intersects(_closure->binary_operators);
 }
 
 bool CltlTranslator::Node::is_consistent() const {
-    FormulaList truths;
-    FormulaList negations;
-
-    for (auto f : _terms) {
-        if (f->formula_type() == CltlFormula::kUnaryOperator) {
-            UnaryOperator *uo = static_cast<UnaryOperator*>(f.get());
-            if (uo->operator_type() == UnaryOperator::kNot) {
-                negations.push_back(uo->operand());
-                continue;
-            }
-        } else if (f->formula_type() == CltlFormula::kConstantExpression) {
-            ConstantExpression *ce = static_cast<ConstantExpression*>(f.get());
-            if (!ce->value())
-                return false;
-        }
-        truths.push_back(f);
-    }
+    if (_terms.intersects(_closure->false_constants))
+        return false;
 
-    for (auto f : negations) {
-        if (std::find(truths.begin(), truths.end(), f) != truths.end())
+    // a negation is inconsistent with its operand
+    const DynamicBitset negations = _terms & _closure->negations;
+    for (std::size_t i = negations.find_first(); i != DynamicBitset::npos; i = negations.find_next(i)) {
+        if (_terms.test(_closure->negated_operand[i]))
             return false;
     }
 
@@ -473,7 +606,7 @@ bool CltlTranslator::Node::is_consistent() const {
 
 const std::string CltlTranslator::Node::dump(const std::string &sep) const {
     std::string node_name = "";
-    for (const auto t : _terms) {
+    for (const auto &t : terms()) {
         node_name += "[" + t->dump() + "]" + sep + " ";
     }
     return node_name;
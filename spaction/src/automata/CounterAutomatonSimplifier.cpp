@@ -0,0 +1,424 @@
+// This source file is part of spaction
+//
+// Copyright 2014 Software Modeling and Verification Group
+// University of Geneva
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "automata/CounterAutomatonSimplifier.h"
+
+#include <algorithm>
+#include <set>
+#include <stack>
+#include <unordered_map>
+
+#include "ConstantExpression.h"
+#include "UnaryOperator.h"
+#include "bitset/DynamicBitset.h"
+
+namespace spaction {
+namespace automata {
+
+std::ostream &operator<<(std::ostream &os, const SimplificationReport &report) {
+    return os << report.pass << ": "
+              << report.states_before << " -> " << report.states_after << " states, "
+              << report.transitions_before << " -> " << report.transitions_after << " transitions, "
+              << report.counters_before << " -> " << report.counters_after << " counters";
+}
+
+CounterAutomatonSimplifier::CounterAutomatonSimplifier(automaton_type &automaton) :
+    _automaton(automaton), _initial(0), _num_counters(automaton.num_counters()) {
+    auto ts = automaton.transition_system();
+
+    std::unordered_map<CltlTranslator::Node*, std::size_t> index;
+    for (auto q : ts->states()) {
+        index.emplace(q, _states.size());
+        _states.push_back(q);
+    }
+    for (std::size_t i = 0; i != _states.size(); ++i) {
+        for (auto t : (*ts)(_states[i]).successors()) {
+            _edges.push_back({i, index.at(t->sink()), t->label()});
+        }
+    }
+    _initial = index.at(*automaton.initial_state());
+}
+
+const std::vector<SimplificationReport> &CounterAutomatonSimplifier::run() {
+    prune();
+    // dropping counters lets more transitions and states be merged
+    reduce_counters();
+    // fewer transitions make the simulation cheaper to compute
+    remove_subsumed_transitions();
+    merge_equivalent_states();
+    // merging yields parallel transitions, and may disconnect the states of the merged ones
+    remove_subsumed_transitions();
+    prune();
+    apply();
+    return _reports;
+}
+
+const SimplificationReport &CounterAutomatonSimplifier::prune() {
+    _begin_report("prune");
+
+    // an unsatisfiable transition is never taken
+    std::vector<Edge> edges;
+    for (const auto &e : _edges) {
+        if (!_is_false(e.label))
+            edges.push_back(e);
+    }
+    _edges.swap(edges);
+
+    std::vector<bool> keep = _useful_states();
+
+    // the initial state remains, even if the automaton accepts no word
+    keep[_initial] = true;
+    _restrict(keep);
+
+    return _end_report();
+}
+
+const SimplificationReport &CounterAutomatonSimplifier::remove_subsumed_transitions() {
+    _begin_report("transition subsumption");
+
+    // group the transitions by source and sink
+    std::vector<std::size_t> sorted(_edges.size());
+    for (std::size_t i = 0; i != sorted.size(); ++i)
+        sorted[i] = i;
+    std::sort(sorted.begin(), sorted.end(), [this](std::size_t l, std::size_t r) {
+        return std::make_pair(_edges[l].source, _edges[l].sink)
+             < std::make_pair(_edges[r].source, _edges[r].sink);
+    });
+
+    std::vector<bool> removed(_edges.size(), false);
+    for (std::size_t first = 0, last = 0; first != sorted.size(); first = last) {
+        const Edge &f = _edges[sorted[first]];
+        while (last != sorted.size() and _edges[sorted[last]].source == f.source
+               and _edges[sorted[last]].sink == f.sink) {
+            ++last;
+        }
+        // among equal transitions, the first one examined is removed, and the others kept
+        for (std::size_t i = first; i != last; ++i) {
+            for (std::size_t j = first; j != last and !removed[sorted[i]]; ++j) {
+                if (i != j and !removed[sorted[j]]
+                    and _subsumes(_edges[sorted[j]].label, _edges[sorted[i]].label)) {
+                    removed[sorted[i]] = true;
+                }
+            }
+        }
+    }
+
+    std::vector<Edge> edges;
+    for (std::size_t i = 0; i != _edges.size(); ++i) {
+        if (!removed[i])
+            edges.push_back(_edges[i]);
+    }
+    _edges.swap(edges);
+
+    return _end_report();
+}
+
+const SimplificationReport &CounterAutomatonSimplifier::merge_equivalent_states() {
+    _begin_report("simulation merge");
+
+    const std::size_t n = _states.size();
+    std::vector<std::vector<std::size_t>> out(n);
+    for (std::size_t i = 0; i != _edges.size(); ++i)
+        out[_edges[i].source].push_back(i);
+
+    // simulators[q] is the set of states that simulate q, refined down to the greatest fixpoint
+    std::vector<DynamicBitset> simulators(n, DynamicBitset(n));
+    for (std::size_t q = 0; q != n; ++q) {
+        for (std::size_t p = 0; p != n; ++p)
+            simulators[q].set(p);
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (std::size_t q = 0; q != n; ++q) {
+            for (std::size_t p = simulators[q].find_first(); p != DynamicBitset::npos;
+                 p = simulators[q].find_next(p)) {
+                if (p == q)
+                    continue;
+                // every transition of q must be matched by a transition of p
+                bool simulates = std::all_of(out[q].begin(), out[q].end(), [&](std::size_t e) {
+                    return std::any_of(out[p].begin(), out[p].end(), [&](std::size_t f) {
+                        return simulators[_edges[e].sink].test(_edges[f].sink)
+                            and _subsumes(_edges[f].label, _edges[e].label);
+                    });
+                });
+                if (!simulates) {
+                    simulators[q].reset(p);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // each class of states simulating each other is represented by its first state
+    std::vector<std::size_t> representative(n, n);
+    for (std::size_t q = 0; q != n; ++q) {
+        if (representative[q] != n)
+            continue;
+        representative[q] = q;
+        for (std::size_t p = simulators[q].find_next(q); p != DynamicBitset::npos;
+             p = simulators[q].find_next(p)) {
+            if (representative[p] == n and simulators[p].test(q))
+                representative[p] = q;
+        }
+    }
+
+    // the transitions of a representative, redirected to representatives, match those of its class
+    std::vector<Edge> edges;
+    for (const auto &e : _edges) {
+        if (representative[e.source] == e.source)
+            edges.push_back({e.source, representative[e.sink], e.label});
+    }
+    _edges.swap(edges);
+    _initial = representative[_initial];
+
+    std::vector<bool> keep(n);
+    for (std::size_t q = 0; q != n; ++q)
+        keep[q] = representative[q] == q;
+    _restrict(keep);
+
+    return _end_report();
+}
+
+const SimplificationReport &CounterAutomatonSimplifier::reduce_counters() {
+    _begin_report("counter reduction");
+
+    // a counter only influences the value of a run through its checks, so that the counters never
+    // checked along an accepting run are useless
+    const std::vector<bool> useful = _useful_states();
+    std::vector<bool> checked(_num_counters, false);
+    for (const auto &e : _edges) {
+        if (!useful[e.source] or !useful[e.sink])
+            continue;
+        const auto &ops = e.label.get_operations();
+        for (std::size_t k = 0; k != _num_counters; ++k) {
+            if (ops[k] & kCheck)
+                checked[k] = true;
+        }
+    }
+
+    // counters with the same operations on every transition always have the same value
+    std::vector<std::size_t> kept;
+    for (std::size_t k = 0; k != _num_counters; ++k) {
+        if (!checked[k])
+            continue;
+        bool duplicate = std::any_of(kept.begin(), kept.end(), [&](std::size_t j) {
+            return std::all_of(_edges.begin(), _edges.end(), [&](const Edge &e) {
+                return e.label.get_operations()[j] == e.label.get_operations()[k];
+            });
+        });
+        if (!duplicate)
+            kept.push_back(k);
+    }
+    // configurations have at least one counter
+    if (kept.empty() and _num_counters != 0)
+        kept.push_back(0);
+
+    if (kept.size() != _num_counters) {
+        std::vector<Edge> edges;
+        for (const auto &e : _edges) {
+            CounterOperations ops(kept.size());
+            for (std::size_t i = 0; i != kept.size(); ++i)
+                ops.set(i, e.label.get_operations()[kept[i]]);
+            edges.push_back({e.source, e.sink,
+                             label_type(e.label.letter(), ops, e.label.get_acceptance())});
+        }
+        _edges.swap(edges);
+        _num_counters = kept.size();
+    }
+
+    return _end_report();
+}
+
+void CounterAutomatonSimplifier::apply() {
+    automaton_type result(_num_counters, _automaton.num_acceptance_sets());
+    auto ts = result.transition_system();
+    for (auto q : _states)
+        ts->add_state(q);
+    for (const auto &e : _edges)
+        ts->add_transition(_states[e.source], _states[e.sink], e.label);
+    result.set_initial_state(_states[_initial]);
+    ts->freeze();
+
+    _automaton = std::move(result);
+}
+
+CounterAutomatonSimplifier::SCCDecomposition CounterAutomatonSimplifier::_decompose() const {
+    const std::size_t n = _states.size();
+    std::vector<std::vector<std::size_t>> succs(n);
+    for (const auto &e : _edges)
+        succs[e.source].push_back(e.sink);
+
+    SCCDecomposition result;
+    std::vector<std::size_t> &scc = result.scc;
+    scc.assign(n, npos);
+
+    // iterative Tarjan, from the initial state
+    std::vector<std::size_t> order(n, npos), lowlink(n, 0);
+    std::vector<bool> on_stack(n, false);
+    std::stack<std::size_t> stack;
+    // the DFS stack, as pairs (state, next successor to visit)
+    std::stack<std::pair<std::size_t, std::size_t>> dfs;
+    std::size_t num = 0, num_sccs = 0;
+    order[_initial] = lowlink[_initial] = num++;
+    stack.push(_initial);
+    on_stack[_initial] = true;
+    dfs.push(std::make_pair(_initial, 0));
+    while (!dfs.empty()) {
+        std::size_t q = dfs.top().first;
+        std::size_t &next = dfs.top().second;
+        if (next != succs[q].size()) {
+            std::size_t s = succs[q][next++];
+            if (order[s] == npos) {
+                order[s] = lowlink[s] = num++;
+                stack.push(s);
+                on_stack[s] = true;
+                dfs.push(std::make_pair(s, 0));
+            } else if (on_stack[s]) {
+                lowlink[q] = std::min(lowlink[q], order[s]);
+            }
+            continue;
+        }
+        dfs.pop();
+        if (!dfs.empty())
+            lowlink[dfs.top().first] = std::min(lowlink[dfs.top().first], lowlink[q]);
+        if (lowlink[q] == order[q]) {
+            std::size_t s;
+            do {
+                s = stack.top();
+                stack.pop();
+                on_stack[s] = false;
+                scc[s] = num_sccs;
+            } while (s != q);
+            ++num_sccs;
+        }
+    }
+
+    // an SCC is accepting if its inner transitions form a cycle visiting every acceptance set
+    std::vector<AcceptanceSet> scc_acceptance(num_sccs);
+    std::vector<bool> has_cycle(num_sccs, false);
+    for (const auto &e : _edges) {
+        if (scc[e.source] == npos or scc[e.source] != scc[e.sink])
+            continue;
+        has_cycle[scc[e.source]] = true;
+        scc_acceptance[scc[e.source]] |= e.label.get_acceptance();
+    }
+    result.accepting.resize(num_sccs);
+    for (std::size_t i = 0; i != num_sccs; ++i) {
+        result.accepting[i] = has_cycle[i]
+            and scc_acceptance[i].size() == _automaton.num_acceptance_sets();
+    }
+
+    return result;
+
+}
+
+std::vector<bool> CounterAutomatonSimplifier::_useful_states() const {
+    const SCCDecomposition sccs = _decompose();
+
+    const std::size_t n = _states.size();
+    std::vector<std::vector<std::size_t>> preds(n);
+    for (const auto &e : _edges)
+        preds[e.sink].push_back(e.source);
+
+    // the reachable states from which an accepting SCC is reachable
+    std::vector<bool> keep(n, false);
+    std::stack<std::size_t> todo;
+    for (std::size_t q = 0; q != n; ++q) {
+        if (sccs.scc[q] != npos and sccs.accepting[sccs.scc[q]]) {
+            keep[q] = true;
+            todo.push(q);
+        }
+    }
+    while (!todo.empty()) {
+        std::size_t q = todo.top();
+        todo.pop();
+        for (auto p : preds[q]) {
+            if (sccs.scc[p] != npos and !keep[p]) {
+                keep[p] = true;
+                todo.push(p);
+            }
+        }
+    }
+
+
+    return keep;
+}
+
+void CounterAutomatonSimplifier::_begin_report(const std::string &pass) {
+    _reports.push_back({pass, _states.size(), 0, _edges.size(), 0, _num_counters, 0});
+}
+
+const SimplificationReport &CounterAutomatonSimplifier::_end_report() {
+    _reports.back().states_after = _states.size();
+    _reports.back().transitions_after = _edges.size();
+    _reports.back().counters_after = _num_counters;
+    return _reports.back();
+}
+
+void CounterAutomatonSimplifier::_restrict(const std::vector<bool> &keep) {
+    assert(keep[_initial]);
+
+    std::vector<std::size_t> index(_states.size());
+    std::vector<CltlTranslator::Node*> states;
+    for (std::size_t q = 0; q != _states.size(); ++q) {
+        if (keep[q]) {
+            index[q] = states.size();
+            states.push_back(_states[q]);
+        }
+    }
+
+    std::vector<Edge> edges;
+    for (const auto &e : _edges) {
+        if (keep[e.source] and keep[e.sink])
+            edges.push_back({index[e.source], index[e.sink], e.label});
+    }
+
+    _initial = index[_initial];
+    _states.swap(states);
+    _edges.swap(edges);
+}
+
+bool CounterAutomatonSimplifier::_subsumes(const label_type &l, const label_type &r) {
+    static const auto compare = CltlTranslator::get_formula_order();
+    return l.get_operations() == r.get_operations()
+        and l.get_acceptance().includes(r.get_acceptance())
+        // the letters are conjunctions of literals, sorted by `compare`
+        and std::includes(r.letter().begin(), r.letter().end(),
+                          l.letter().begin(), l.letter().end(), compare);
+}
+
+bool CounterAutomatonSimplifier::_is_false(const label_type &label) {
+    const auto &letter = label.letter();
+    for (const auto &f : letter) {
+        if (f->formula_type() == CltlFormula::kConstantExpression
+            and !static_cast<ConstantExpression*>(f.get())->value()) {
+            return true;
+        }
+        if (f->formula_type() == CltlFormula::kUnaryOperator) {
+            const UnaryOperator *u = static_cast<UnaryOperator*>(f.get());
+            if (u->operator_type() == UnaryOperator::kNot
+                and std::find(letter.begin(), letter.end(), u->operand()) != letter.end()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}  // namespace automata
+}  // namespace spaction
@@ -54,6 +54,7 @@ typedef std::list<parse_error> parse_error_list;
 %parse-param {spaction::CltlFormulaPtr &result}
 %parse-param {spaction::cltlparse::CLTLScanner &scanner}
 %parse-param {parse_error_list &error_list}
+%parse-param {spaction::CltlFormulaFactory &factory}
 
 /* token types */
 %type   <form>                      formula
@@ -101,21 +102,21 @@ whole_formula: formula END { result = $1; };
 formula
 : atomic                    { $$ = $1; }
 | constant                  { $$ = $1; }
-| unary formula             { $$ = _factory().make_unary($1, $2); }
-| formula IMPLY formula     { $$ = _factory().make_imply($1, $3); }
-| formula binary formula    { $$ = _factory().make_binary($2, $1, $3); }
+| unary formula             { $$ = factory.make_unary($1, $2); }
+| formula IMPLY formula     { $$ = factory.make_imply($1, $3); }
+| formula binary formula    { $$ = factory.make_binary($2, $1, $3); }
 | LPAR formula RPAR         { $$ = $2; }
-| FINALLY formula           { $$ = _factory().make_finally($2); }
-| GLOBALLY formula          { $$ = _factory().make_globally($2); }
-| COSTFINALLY formula       { $$ = _factory().make_costfinally($2); }
-| COSTGLOBALLY formula      { $$ = _factory().make_costglobally($2); }
+| FINALLY formula           { $$ = factory.make_finally($2); }
+| GLOBALLY formula          { $$ = factory.make_globally($2); }
+| COSTFINALLY formula       { $$ = factory.make_costfinally($2); }
+| COSTGLOBALLY formula      { $$ = factory.make_costglobally($2); }
 ;
 
-atomic: ATOM                { $$ = _factory().make_atomic($1); };
+atomic: ATOM                { $$ = factory.make_atomic($1); };
 
 constant
-: TRUE                      { $$ = _factory().make_constant(true); }
-| FALSE                     { $$ = _factory().make_constant(false); }
+: TRUE                      { $$ = factory.make_constant(true); }
+| FALSE                     { $$ = factory.make_constant(false); }
 ;
 
 unary
@@ -139,7 +140,7 @@ void yy::parser::error(const location_type &location, const std::string &message
 }
 
 spaction::CltlFormulaFactory & _factory() {
-    static spaction::CltlFormulaFactory f = spaction::CltlFormulaFactory();
+    static spaction::CltlFormulaFactory f;
     return f;
 }
 
@@ -155,11 +156,15 @@ namespace spaction {
 namespace cltlparse {
 
 CltlFormulaPtr parse_formula(const std::string &ltl_string) {
+    return parse_formula(ltl_string, _factory());
+}
+
+CltlFormulaPtr parse_formula(const std::string &ltl_string, CltlFormulaFactory &factory) {
     CltlFormulaPtr f = nullptr;
     std::istringstream in = std::istringstream(ltl_string);
     parse_error_list error_list;
     CLTLScanner s(&in);
-    yy::parser p(f, s, error_list);
+    yy::parser p(f, s, error_list, factory);
     p.parse();
 
     // code copied from SPOT
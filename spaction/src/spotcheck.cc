@@ -17,13 +17,20 @@
 
 #include "spotcheck.h"
 
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <fstream>
+#include <limits>
 #include <sstream>
+#include <vector>
 
 #include <iface/dve2/dve2.hh>
 #include <ltlparse/public.hh>
 #include <tgba/tgbaproduct.hh>
 #include <tgbaalgos/dotty.hh>
+#include <tgbaalgos/dupexp.hh>
 #include <tgbaalgos/emptiness.hh>
 #include <tgbaalgos/stats.hh>
 #include <tgbaalgos/translate.hh>
@@ -31,8 +38,12 @@
 #include "AtomicProposition.h"
 #include "CltlFormulaFactory.h"
 #include "automata/CltlTranslator.h"
+#include "automata/ConjunctionTranslator.h"
 #include "automata/CounterAutomatonProduct.h"
+#include "automata/CounterAutomatonSimplifier.h"
+#include "automata/ParallelSupremumFinder.h"
 #include "automata/SupremumFinder.h"
+#include "automata/BoundedCounterAutomaton.h"
 #include "automata/TGBA2CA.h"
 
 #include "Instantiator.h"
@@ -42,58 +53,114 @@
 
 namespace spaction {
 
-bool spot_dve_check(const std::string &formula, const std::string &modelfile) {
-    // spot parsing of the instantiated formula
-    spot::ltl::parse_error_list pel;
-    const spot::ltl::formula *ltl_formula = spot::ltl::parse(formula, pel);
-    if (spot::ltl::format_parse_errors(std::cerr, formula, pel)) {
-        ltl_formula->destroy();
-        exit(1);
+/// A CLTL formula visitor to collect the AP used by a formula.
+class APCollector : public CltlFormulaVisitor {
+ public:
+    virtual ~APCollector() { }
+
+    void visit(const std::shared_ptr<AtomicProposition> &formula) final {
+        spaction::Logger<std::cerr>::instance().info() << "visiting AP " << formula->value() << std::endl;
+        _res.insert(spot::ltl::atomic_prop::instance(formula->value(), spot::ltl::default_environment::instance()));
     }
 
-    spaction::Logger<std::cerr>::instance().info() << "spot parsing done" << std::endl;
+    void visit(const std::shared_ptr<ConstantExpression> &formula) final {}
+    void visit(const std::shared_ptr<UnaryOperator> &formula) final {
+        formula->operand()->accept(*this);
+    }
+    void visit(const std::shared_ptr<BinaryOperator> &formula) final {
+        formula->left()->accept(*this);
+        formula->right()->accept(*this);
+    }
 
-    // to store atomic propositions appearing in the formula
-    spot::ltl::atomic_prop_set atomic_propositions;
-    // bdd dictionnary
-    spot::bdd_dict *bdd_dictionnary = new spot::bdd_dict();
+    spot::ltl::atomic_prop_set get() const { return _res; }
+
+ private:
+    spot::ltl::atomic_prop_set _res;
+};
+
+static spot::ltl::atomic_prop_set collect_atomic_propositions(const CltlFormulaPtr &formula) {
+    auto visitor = APCollector();
+    formula->accept(visitor);
+
+    spaction::Logger<std::cerr>::instance().info() << "atomic propositions collected" << std::endl;
+
+    return visitor.get();
+}
+
+BoundSearchSession::BoundSearchSession(const std::string &modelfile,
+                                       const spot::ltl::atomic_prop_set &aps)
+: _dict(new spot::bdd_dict())
+, _model(nullptr)
+, _explicit_model(nullptr)
+, _model_size(0)
+, _echeck_inst(nullptr) {
+    // load divine model
+    _model = spot::load_dve2(modelfile, _dict, &aps);
+    if (!_model) {
+        spaction::Logger<std::cerr>::instance().fatal() << "DVE model " << modelfile << " could not be loaded" << std::endl;
+        delete _dict;
+        throw std::runtime_error("Fail to load DVE model");
+    }
+
+    spaction::Logger<std::cerr>::instance().info() << "dve loaded" << std::endl;
+
+    // explore the model once and for all
+    _explicit_model = spot::tgba_dupexp_bfs(_model);
+    _model_size = spot::stats_reachable(_explicit_model).states;
+
+    spaction::Logger<std::cerr>::instance().info() << "model explored, " << _model_size << " states" << std::endl;
+
+    {  // build the instantiator
+        // @todo add an option to select what EC to use
+        const char* echeck_algo = "Cou99";
+        const char* err;
+        _echeck_inst = spot::emptiness_check_instantiator::construct(echeck_algo, &err);
+        // check correct instantiation.
+        // according to spot documentation, `construct` returns 0 on failure, and an error log in err.
+        if (!_echeck_inst) {
+            spaction::Logger<std::cerr>::instance().fatal() << "Emptiness Check Instantiator could not be built: " << err << " is not recognized" << std::endl;
+            delete _explicit_model;
+            delete _model;
+            delete _dict;
+            throw std::runtime_error("Fail to build Emptiness Check Instantiator");
+        }
+    }
+}
+
+BoundSearchSession::BoundSearchSession(const std::string &modelfile, const CltlFormulaPtr &formula)
+: BoundSearchSession(modelfile, collect_atomic_propositions(formula))
+{}
+
+BoundSearchSession::~BoundSearchSession() {
+    delete _echeck_inst;
+    delete _explicit_model;
+    delete _model;
+    delete _dict;
+}
+
+bool BoundSearchSession::check(const spot::ltl::formula *formula) {
+    const spot::ltl::formula *ltl_formula = formula->clone();
     const spot::tgba *property_automaton;
     // NB: embedding the translation in a block is mandatory for proper deallocation
     {
         // translate the formula into an automaton
-        spot::translator formula_translator(bdd_dictionnary);
+        spot::translator formula_translator(_dict);
         property_automaton = formula_translator.run(&ltl_formula);
     }
 
     spaction::Logger<std::cerr>::instance().info() << "property tgba built" << std::endl;
 
-    // collect atomic propositions from formula
-    atomic_prop_collect(ltl_formula, &atomic_propositions);
-
-    spaction::Logger<std::cerr>::instance().info() << "ap collected" << std::endl;
-
-    // load divine model
-    spot::kripke *model = spot::load_dve2(modelfile, bdd_dictionnary, &atomic_propositions);
-
-    spaction::Logger<std::cerr>::instance().info() << "dve loaded" << std::endl;
-
     // synchronized product of both automata
-    spot::tgba *product = new spot::tgba_product(model, property_automaton);
+    spot::tgba *product = new spot::tgba_product(_explicit_model, property_automaton);
 
     spaction::Logger<std::cerr>::instance().info() << "product automaton built" << std::endl;
 
-    // emptiness check of the product automaton
-    const char* echeck_algo = "Cou99";
-    const char* err;
-    spot::emptiness_check_instantiator* echeck_inst = nullptr;
-    echeck_inst = spot::emptiness_check_instantiator::construct(echeck_algo, &err);
-    // \todo properly catch incorrect instantiation of emptiness checker
-    assert(echeck_inst);
-
     // the real emptiness check
-    spot::emptiness_check* emptiness_checker = echeck_inst->instantiate(product);
-    // \todo properly catch incorrect instantation
-    assert(emptiness_checker);
+    spot::emptiness_check* emptiness_checker = _echeck_inst->instantiate(product);
+    if (!emptiness_checker) {
+        spaction::Logger<std::cerr>::instance().fatal() << "Emptiness checker could not be built" << std::endl;
+        throw std::runtime_error("Fail to build Emptiness checker");
+    }
 
     spaction::Logger<std::cerr>::instance().info() << "emptichecker built" << std::endl;
 
@@ -107,56 +174,104 @@ bool spot_dve_check(const std::string &formula, const std::string &modelfile) {
     bool to_return = !result;
     spaction::Logger<std::cerr>::instance().info() << "result of emptiness check is " << to_return << std::endl;
 
-    // free all the stuff
+    // free all the stuff, but the model
     delete result;
+    delete emptiness_checker;
     delete product;
-    delete model;
     delete property_automaton;
-    delete bdd_dictionnary;
     ltl_formula->destroy();
 
     // return the result
     return to_return;
 }
 
+bool spot_dve_check(const std::string &formula, const std::string &modelfile) {
+    // spot parsing of the instantiated formula
+    spot::ltl::parse_error_list pel;
+    const spot::ltl::formula *ltl_formula = spot::ltl::parse(formula, pel);
+    if (spot::ltl::format_parse_errors(std::cerr, formula, pel)) {
+        ltl_formula->destroy();
+        exit(1);
+    }
+
+    spaction::Logger<std::cerr>::instance().info() << "spot parsing done" << std::endl;
+
+    // collect atomic propositions from formula
+    spot::ltl::atomic_prop_set atomic_propositions;
+    atomic_prop_collect(ltl_formula, &atomic_propositions);
+
+    spaction::Logger<std::cerr>::instance().info() << "ap collected" << std::endl;
+
+    bool result;
+    {
+        // a single-use session
+        BoundSearchSession session(modelfile, atomic_propositions);
+        result = session.check(ltl_formula);
+    }
+    ltl_formula->destroy();
+
+    return result;
+}
+
 // @param formula is assumed to be CLTL[<=]
-static bool spot_check_inf(const CltlFormulaPtr &formula, int n, const std::string &modelname) {
+// @param instantiator is shared by the probes of a search, so that they reuse its memoized
+//        instantiations
+static bool spot_check_inf(const CltlFormulaPtr &formula, int n, InstantiateInf &instantiator,
+                           BoundSearchSession &session) {
     assert(formula->is_infltl());
     // instantiate the cost formula
-    std::string ltl_string;
-    InstantiateInf instanciator;
-
-    const CltlFormulaPtr &tmp = instanciator(formula, n);
-    ltl_string = tmp->dump();
-    // to please spot, replace single quotes by double quotes around atomic propostions
-    std::replace(ltl_string.begin(), ltl_string.end(), '\'', '"');
-    return spot_dve_check(ltl_string, modelname);
+    const CltlFormulaPtr &tmp = instantiator(formula, n);
+    // convert the instantiated formula to spot, rather than dumping it and parsing it back
+    const spot::ltl::formula *ltl_formula = cltl2spot(tmp);
+    bool result = session.check(ltl_formula);
+    ltl_formula->destroy();
+    return result;
 }
 
-// @param   formula is assumed to be CLTL[<=]
-// @todo    do not use 'blind' dichotomy, use bound |aut| \times |system|
-unsigned int find_bound_min_dichoto(const CltlFormulaPtr &formula, const std::string &modelname) {
-    assert(formula->is_infltl());
-    // min holds the greatest tested number for which spot_check returns true
-    // max holds the smallest tested number for which spot_check returns false
+// @param formula is assumed to be CLTL[>]
+// @param instantiator is shared by the probes of a search (see spot_check_inf)
+static bool spot_check_sup(const CltlFormulaPtr &formula, int n, InstantiateSup &instantiator,
+                           BoundSearchSession &session) {
+    assert(formula->is_supltl());
+    // instantiate the cost formula
+    const CltlFormulaPtr &tmp = instantiator(formula, n);
+    const spot::ltl::formula *ltl_formula = cltl2spot(tmp);
+    bool result = session.check(ltl_formula);
+    ltl_formula->destroy();
+    return result;
+}
+
+// finds the greatest n for which `probe(n)` holds, by an exponential then dichotomic search
+// @param   probe is assumed to be monotonic: if probe(n) holds, then so does probe(m) for m <= n
+// @param   limit is the greatest n to probe: probe is assumed not to hold beyond
+// @return  the greatest n <= limit such that probe(n) holds, or 0 if probe(0) does not hold
+// @note    without a limit, probe must not hold for all n, otherwise the search does not terminate
+template<typename Probe>
+static unsigned int find_greatest_dichoto(const Probe &probe,
+                                          unsigned int limit = std::numeric_limits<unsigned int>::max()) {
+    auto holds = [&](unsigned int n) { return n <= limit and probe(n); };
+
+    // min holds the greatest tested number for which probe returns true
+    // max holds the smallest tested number for which probe returns false
     unsigned int max = 0;
     unsigned int min = 0;
 
-    if (!spot_check_inf(formula, max, modelname))
+    if (!holds(max))
         return max;
 
-    // increase
+    // increase, saturating at limit
     do {
-        // \todo safe checks to detect int overflow
+        if (max == limit)
+            return max;
+        min = max;
         if (!max)   max = 1;
-        else        max *= 2;
-    } while (spot_check_inf(formula, max, modelname));
+        else        max = max > limit / 2 ? limit : 2 * max;
+    } while (holds(max));
 
     // decrease
-    min = max / 2;
     while (min + 1 != max) {
-        unsigned int tmp = (min + max) / 2;
-        if (spot_check_inf(formula, tmp, modelname))
+        unsigned int tmp = min + (max - min) / 2;
+        if (holds(tmp))
             min = tmp;
         else
             max = tmp;
@@ -164,87 +279,201 @@ unsigned int find_bound_min_dichoto(const CltlFormulaPtr &formula, const std::st
     return min;
 }
 
-// @param formula is assumed to be CLTL[>]
-static bool spot_check_sup(const CltlFormulaPtr &formula, int n, const std::string &modelname) {
-    assert(formula->is_supltl());
-    // instantiate the cost formula
-    std::string ltl_string;
-    InstantiateSup instanciator;
+// evaluates `probe` on every candidate, each in its own worker process
+// @remarks
+//          neither BuDDy nor the formula factories are thread-safe, so the probes are not run in
+//          threads but in forked processes. Every worker thus gets its own copy of the factories
+//          and of the bdd dictionary, while the (already explored) model is shared copy-on-write.
+// @remarks
+//          as `probe` is monotonic and `candidates` increasing, once a candidate fails, the
+//          results of the greater ones are known: their workers are killed rather than waited
+//          for, since probing a great candidate may be much slower.
+// @return  the results of the probes, in the order of `candidates`
+template<typename Probe>
+static std::vector<bool> probe_in_parallel(const Probe &probe,
+                                           const std::vector<unsigned int> &candidates) {
+    std::vector<pid_t> workers;
+    std::vector<int> channels;
+    bool failure = false;
+
+    for (auto n : candidates) {
+        int fds[2];
+        if (pipe(fds) == -1) {
+            failure = true;
+            break;
+        }
+        pid_t pid = fork();
+        if (pid == -1) {
+            close(fds[0]);
+            close(fds[1]);
+            failure = true;
+            break;
+        }
+        if (pid == 0) {
+            // worker: run the probe and send back its result
+            close(fds[0]);
+            char result;
+            try {
+                result = probe(n) ? 1 : 0;
+            } catch (...) {
+                _exit(1);
+            }
+            _exit(write(fds[1], &result, 1) == 1 ? 0 : 1);
+        }
+        close(fds[1]);
+        workers.push_back(pid);
+        channels.push_back(fds[0]);
+    }
+
+    // collect the results in order, until a candidate fails or a worker does
+    std::vector<bool> results(workers.size(), false);
+    bool refuted = false;
+    for (std::size_t i = 0; i != workers.size(); ++i) {
+        if (refuted or failure) {
+            kill(workers[i], SIGKILL);
+            close(channels[i]);
+            waitpid(workers[i], nullptr, 0);
+            continue;
+        }
+        char result = 0;
+        bool received = read(channels[i], &result, 1) == 1;
+        close(channels[i]);
+        int status;
+        waitpid(workers[i], &status, 0);
+        if (!received or !WIFEXITED(status) or WEXITSTATUS(status) != 0)
+            failure = true;
+        results[i] = result;
+        refuted = !result;
+    }
 
-    const CltlFormulaPtr &tmp = instanciator(formula, n);
-    ltl_string = tmp->dump();
-    return spot_dve_check(ltl_string, modelname);
+    if (failure) {
+        spaction::Logger<std::cerr>::instance().fatal() << "a probe worker failed" << std::endl;
+        throw std::runtime_error("Fail to run the probes in parallel");
+    }
+    return results;
+}
+
+// finds the greatest n for which `probe(n)` holds, by a k-ary search where k is `jobs`
+// @remarks
+//          the increasing phase speculatively probes `jobs` candidates at once, evenly spaced
+//          above the greatest one known to hold: 0 to jobs - 1 first, then with a step that
+//          doubles at every round. No candidate is thus far beyond the values known to hold,
+//          since the cost of a probe grows with n. The dichotomic phase splits the remaining
+//          interval in `jobs + 1` parts instead of 2. Candidates saturate at `limit`.
+// @see     find_greatest_dichoto for the expected properties of `probe`, and for `limit`
+template<typename Probe>
+static unsigned int find_greatest_parallel(const Probe &probe, unsigned int jobs,
+                                           unsigned int limit = std::numeric_limits<unsigned int>::max()) {
+    if (jobs <= 1)
+        return find_greatest_dichoto(probe, limit);
+
+    // min holds the greatest tested number for which probe returns true (if any)
+    // max holds the smallest tested number for which probe returns false
+    bool found = false;
+    unsigned int min = 0;
+    unsigned int max = 0;
+    std::vector<unsigned int> candidates;
+
+    // increase: probe 0 to jobs - 1, then batches of `jobs` candidates above min
+    unsigned long long step = 1;
+    for (bool done = false; !done; ) {
+        if (found and min == limit)
+            return min;
+        candidates.clear();
+        unsigned long long first = found ? min + step : 0;
+        for (unsigned int i = 0; i != jobs; ++i) {
+            unsigned long long n = first + step * i;
+            candidates.push_back(n < limit ? n : limit);
+            if (n >= limit)
+                break;
+        }
+        if (step < limit)
+            step *= 2;
+        const std::vector<bool> &results = probe_in_parallel(probe, candidates);
+        for (std::size_t i = 0; i != candidates.size(); ++i) {
+            if (!results[i]) {
+                max = candidates[i];
+                done = true;
+                break;
+            }
+            min = candidates[i];
+            found = true;
+        }
+    }
+    if (!found)
+        return 0;
+
+    // decrease: split ]min, max[ in `jobs + 1` parts
+    while (min + 1 != max) {
+        candidates.clear();
+        for (unsigned int i = 1; i <= jobs; ++i) {
+            unsigned int n = min + static_cast<unsigned long long>(max - min) * i / (jobs + 1);
+            if (n != min and (candidates.empty() or n != candidates.back()))
+                candidates.push_back(n);
+        }
+        const std::vector<bool> &results = probe_in_parallel(probe, candidates);
+        for (std::size_t i = 0; i != candidates.size(); ++i) {
+            if (!results[i]) {
+                max = candidates[i];
+                break;
+            }
+            min = candidates[i];
+        }
+    }
+    return min;
+}
+
+// @param   formula is assumed to be CLTL[<=]
+// @todo    do not use 'blind' dichotomy, use bound |aut| \times |system|
+unsigned int find_bound_min_dichoto(const CltlFormulaPtr &formula, BoundSearchSession &session,
+                                   unsigned int jobs) {
+    assert(formula->is_infltl());
+    // the probes run in forked workers only record their instantiations in their own copy
+    InstantiateInf instantiator;
+    return find_greatest_parallel([&](unsigned int n) {
+        return spot_check_inf(formula, n, instantiator, session);
+    }, jobs);
 }
 
 // @param   formula is assumed to be CLTL[>]
 // @todo    a +1 is probably missing around here
 // @todo    do not use 'blind' dichotomy, use bound |aut| \times |system|
-unsigned int find_bound_max_dichoto(const CltlFormulaPtr &formula, const std::string &modelname) {
+unsigned int find_bound_max_dichoto(const CltlFormulaPtr &formula, BoundSearchSession &session,
+                                   unsigned int jobs) {
     assert(formula->is_supltl());
-    // min holds the greatest tested number for which spot_check returns true
-    // max holds the smallest tested number for which spot_check returns false
-    unsigned int max = 0;
-    unsigned int min = 0;
-
-    if (spot_check_sup(formula, max, modelname))
-        return max;
-
-    // increase
-    do {
-        // \todo safe checks to detect int overflow
-        if (!max)   max = 1;
-        else        max *= 2;
-    } while (!spot_check_sup(formula, max, modelname));
+    InstantiateSup instantiator;
+    return find_greatest_parallel([&](unsigned int n) {
+        return !spot_check_sup(formula, n, instantiator, session);
+    }, jobs);
+}
 
-    // decrease
-    min = max / 2;
-    while (min + 1 != max) {
-        unsigned int tmp = (min + max) / 2;
-        if (!spot_check_sup(formula, tmp, modelname))
-            min = tmp;
-        else
-            max = tmp;
+// reduces the automaton built by `translator`, and logs the effect of each pass
+static void simplify_automaton(automata::CltlTranslator &translator) {
+    automata::CounterAutomatonSimplifier simplifier(translator.get_automaton());
+    for (auto &report : simplifier.run()) {
+        spaction::Logger<std::cerr>::instance().info() << "simplification, " << report << std::endl;
     }
-    return min;
 }
 
 // @param   formula is assumed to be CLTL[>]
-automata::value_t find_max_cegar(const CltlFormulaPtr &formula,
-                                 spot::kripke *model,
-                                 spot::bdd_dict *dict) {
+automata::value_t find_max_cegar(const CltlFormulaPtr &formula, BoundSearchSession &session) {
     assert(formula->is_supltl());
     // sup \emptyset = 0
     automata::value_t res = {false, 0};
     CltlFormulaPtr phi = formula;
 
     // the emptiness check instantiator
-    spot::emptiness_check_instantiator* echeck_inst = nullptr;
-
-    {  // build the instantiator
-        // @todo add an option to select what EC to use
-        const char* echeck_algo = "Cou99";
-        const char* err;
-        echeck_inst = spot::emptiness_check_instantiator::construct(echeck_algo, &err);
-        // check correct instantiation.
-        // according to spot documentation, `construct` returns 0 on failure, and an error log in err.
-        if (!echeck_inst) {
-            spaction::Logger<std::cerr>::instance().fatal() << "Emptiness Check Instantiator could not be built: " << err << " is not recognized" << std::endl;
-            throw std::runtime_error("Fail to build Emptiness Check Instantiator");
-        }
-    }
-
-    spaction::Logger<std::cerr>::instance().info() << "Emptiness Check Instantiator built" << std::endl;
+    const spot::emptiness_check_instantiator* echeck_inst = session.emptiness_check();
 
     // see the model as a counter automaton
-    assert(model);
-    automata::tgba_ca *model_ca = new automata::tgba_ca(model);
+    automata::tgba_ca *model_ca = new automata::tgba_ca(session.model());
 
     spaction::Logger<std::cerr>::instance().info() << "model loaded as a CA" << std::endl;
 
     // determine the bound to use (|model| \times |automaton of the formula|)
     //@{
-    // compute model size (number of nodes)
-    unsigned int model_size = spot::stats_reachable(model).states;
+    // model size (number of nodes)
+    unsigned int model_size = session.model_size();
     // compute formula automaton size (number of nodes)
     unsigned int formula_aut_size = 0;
     {
@@ -254,6 +483,9 @@ automata::value_t find_max_cegar(const CltlFormulaPtr &formula,
 
         spaction::Logger<std::cerr>::instance().info() << "formula translated to CA" << std::endl;
 
+        // a smaller automaton yields a tighter bound
+        simplify_automaton(translator);
+
         for (auto state : translator.get_automaton().transition_system()->states()) {
             ++formula_aut_size;
         }
@@ -269,9 +501,10 @@ automata::value_t find_max_cegar(const CltlFormulaPtr &formula,
     bool first_pass = true;
     do {
         i++;
-        // build the automaton of phi
+        // build the automaton of phi, on the fly so that only the part reached by the emptiness
+        // check gets translated
         automata::CltlTranslator translator(phi);
-        translator.build_automaton();
+        translator.build_lazy_automaton();
 
         spaction::Logger<std::cerr>::instance().info() << "formula translated to automaton" << std::endl;
 
@@ -279,10 +512,10 @@ automata::value_t find_max_cegar(const CltlFormulaPtr &formula,
 #ifdef TRACE
         std::stringstream ca_file;
         ca_file << "ca_" << i << ".dot";
-        translator.get_automaton().print(ca_file.str());
+        translator.get_lazy_automaton().print(ca_file.str());
 #endif
 
-        auto prod = automata::make_aut_product(translator.get_automaton(), *model_ca, dict, formula->creator());
+        auto prod = automata::make_aut_product(translator.get_lazy_automaton(), *model_ca, session.dict(), formula->creator());
 
 // @todo merge to logging mechanism
 #ifdef TRACE
@@ -359,91 +592,220 @@ automata::value_t find_max_cegar(const CltlFormulaPtr &formula,
     return res;
 }
 
+// a finite supremum over the product is at most `bound`, its number of states, so that a greater
+// `value` is an infinite one. Its exact value is lost anyway, since counters saturate at
+// `bound + 1`.
+static automata::value_t beyond_bound_is_infinite(const automata::value_t &value,
+                                                  unsigned int bound) {
+    if (!value.infinite and value.value > bound)
+        return { true, 0 };
+    return value;
+}
+
+// computes the supremum of the values of the runs of the product of `formula_aut` with the model
+// @param   formula_aut_size is the number of states of `formula_aut`
+// @param   jobs is the number of threads of the search (see ParallelSupremumFinder)
+template<typename Automaton>
+static automata::value_t find_max_direct_in(Automaton &formula_aut, unsigned int formula_aut_size,
+                                            const CltlFormulaPtr &formula,
+                                            BoundSearchSession &session, unsigned int jobs) {
+    automata::tgba_ca *model_ca = new automata::tgba_ca(session.model());
+
+    spaction::Logger<std::cerr>::instance().info() << "model loaded as a CA" << std::endl;
+
+    auto prod = automata::make_aut_product(formula_aut, *model_ca, session.dict(), formula->creator());
+
+    // model size (number of nodes)
+    unsigned int model_size = session.model_size();
+    unsigned int bound = model_size * formula_aut_size;
+
+    if (jobs > 1) {
+        automata::ParallelSupremumFinder sup_comput(automata::make_view(prod), *prod.initial_state(),
+                                                    prod.num_counters(), prod.num_acceptance_sets(),
+                                                    jobs, bound + 1);
+        spaction::Logger<std::cerr>::instance().info()
+            << "product made explicit, " << sup_comput.explicit_view().num_states() << " states, "
+            << sup_comput.explicit_view().num_transitions() << " transitions" << std::endl;
+        automata::value_t result = sup_comput.find_supremum(bound);
+        spaction::Logger<std::cerr>::instance().info()
+            << "interned configurations: " << sup_comput.interned_configurations() << std::endl;
+        delete model_ca;
+        return beyond_bound_is_infinite(result, bound);
+    }
+
+    // the statically dispatched views avoid a virtual call per explored transition, and counters
+    // past the bound need not be told apart
+    auto config_view = automata::make_minmax_view(prod, bound + 1);
+    auto sup_comput = automata::make_sup_comput(config_view,
+                                                config_view.default_config(*prod.initial_state()),
+                                                prod.num_acceptance_sets());
+
+    automata::value_t result = sup_comput.find_supremum(bound);
+    spaction::Logger<std::cerr>::instance().info() << "pruned configurations: "
+                                                   << sup_comput.pruned_configurations()
+                                                   << ", subsumed configurations: "
+                                                   << sup_comput.subsumed_configurations()
+                                                   << ", interned configurations: "
+                                                   << sup_comput.store().interned() << " ("
+                                                   << sup_comput.store().memory() << " bytes)"
+                                                   << std::endl;
+    delete model_ca;
+    return beyond_bound_is_infinite(result, bound);
+}
+
+// the number of states of the automaton built by `translator`
+static unsigned int formula_automaton_size(automata::CltlTranslator &translator) {
+    unsigned int result = 0;
+    for (auto state : translator.get_automaton().transition_system()->states()) {
+        ++result;
+    }
+    return result;
+}
+
 // @param   formula is assumed to be CLTL[>]
-automata::value_t find_max_direct(const CltlFormulaPtr &formula,
-                                  spot::kripke *model,
-                                  spot::bdd_dict *dict) {
+// @remarks
+//      With several jobs, the conjuncts of a top-level conjunction are translated in parallel (see
+//      ConjunctionTranslator), and the supremum is searched by several threads (see
+//      ParallelSupremumFinder).
+automata::value_t find_max_direct(const CltlFormulaPtr &formula, BoundSearchSession &session,
+                                  unsigned int jobs) {
     assert(formula->is_supltl());
-    assert(model);
-    automata::tgba_ca *model_ca = new automata::tgba_ca(model);
+
+    if (jobs > 1 and automata::ConjunctionTranslator::is_conjunction(formula)) {
+        automata::ConjunctionTranslator translator(formula);
+        translator.build_automaton();
+        spaction::Logger<std::cerr>::instance().info() << "conjuncts translated to CA in parallel" << std::endl;
+
+        // the states of the product are the pairs of states of its operands
+        unsigned int formula_aut_size = formula_automaton_size(translator.lhs())
+                                      * formula_automaton_size(translator.rhs());
+        return find_max_direct_in(translator.get_automaton(), formula_aut_size, formula, session,
+                                  jobs);
+    }
+
+    automata::CltlTranslator translator(formula);
+    translator.build_automaton();
+    simplify_automaton(translator);
+
+    return find_max_direct_in(translator.get_automaton(), formula_automaton_size(translator),
+                              formula, session, jobs);
+}
+
+// @param   formula is assumed to be CLTL[>]
+// @remarks
+//      Rather than instantiating the formula for every probed n (see find_bound_max_dichoto), the
+//      product of its counter automaton with the model is built once, and each probe checks the
+//      emptiness of the bounded-counter automaton of this product, with counters capped at n.
+automata::value_t find_max_bounded(const CltlFormulaPtr &formula, BoundSearchSession &session,
+                                   unsigned int jobs) {
+    assert(formula->is_supltl());
+
+    // the emptiness check instantiator
+    const spot::emptiness_check_instantiator* echeck_inst = session.emptiness_check();
+
+    automata::tgba_ca *model_ca = new automata::tgba_ca(session.model());
 
     spaction::Logger<std::cerr>::instance().info() << "model loaded as a CA" << std::endl;
 
     automata::CltlTranslator translator(formula);
     translator.build_automaton();
 
-    auto prod = automata::make_aut_product(translator.get_automaton(), *model_ca, dict, formula->creator());
+    spaction::Logger<std::cerr>::instance().info() << "formula translated to CA" << std::endl;
 
-    auto config_aut = automata::make_minmax_configuration_automaton(prod);
-    auto sup_comput = automata::make_sup_comput(config_aut);
+    simplify_automaton(translator);
 
-    // compute model size (number of nodes)
-    unsigned int model_size = spot::stats_reachable(model).states;
-    // compute formula automaton size (number of nodes)
+    auto prod = automata::make_aut_product(translator.get_automaton(), *model_ca, session.dict(), formula->creator());
+
+    // determine the bound to use (|model| \times |automaton of the formula|)
+    unsigned int model_size = session.model_size();
     unsigned int formula_aut_size = 0;
     for (auto state : translator.get_automaton().transition_system()->states()) {
         ++formula_aut_size;
     }
+    unsigned int upper_bound = model_size * formula_aut_size;
 
-    return sup_comput.find_supremum(model_size * formula_aut_size);
-}
+    // probe(n) holds iff the product has an accepting run of value at least n
+    auto probe = [&](unsigned int n) {
+        auto bounded = automata::make_bounded_counter_automaton(prod, n);
+        auto bounded_tgba = automata::make_tgba(&bounded);
 
-/// A CLTL formula visitor to collect the AP used by a formula.
-class APCollector : public CltlFormulaVisitor {
- public:
-    virtual ~APCollector() { }
+        spot::emptiness_check* emptiness_checker = echeck_inst->instantiate(bounded_tgba);
+        if (!emptiness_checker) {
+            spaction::Logger<std::cerr>::instance().fatal() << "Emptiness checker could not be built" << std::endl;
+            throw std::runtime_error("Fail to build Emptiness checker");
+        }
 
-    void visit(const std::shared_ptr<AtomicProposition> &formula) final {
-        spaction::Logger<std::cerr>::instance().info() << "visiting AP " << formula->value() << std::endl;
-        _res.insert(spot::ltl::atomic_prop::instance(formula->value(), spot::ltl::default_environment::instance()));
-    }
+        spot::emptiness_check_result *result = nullptr;
+        try {
+            result = emptiness_checker->check();
+        } catch (std::bad_alloc) {
+            spaction::Logger<std::cerr>::instance().fatal() << "out of memory during emptiness check" << std::endl;
+            throw std::bad_alloc();
+        }
+        bool is_nonempty = result;
 
-    void visit(const std::shared_ptr<ConstantExpression> &formula) final {}
-    void visit(const std::shared_ptr<UnaryOperator> &formula) final {
-        formula->operand()->accept(*this);
+        spaction::Logger<std::cerr>::instance().info() << "bounded-counter EC done for n = " << n << ", result is " << is_nonempty << std::endl;
+
+        delete result;
+        delete emptiness_checker;
+        delete bounded_tgba;
+        return is_nonempty;
+    };
+
+    // The bounded automata grow with n, so that the values up to the upper bound are searched
+    // first. Above the upper bound, a run can be pumped to reach any value: the value is infinite
+    // iff probe(upper_bound + 1) holds, which is only checked if probe(upper_bound) holds.
+    automata::value_t res;
+    unsigned int greatest = find_greatest_parallel(probe, jobs, upper_bound);
+    if (greatest == upper_bound and probe(upper_bound + 1)) {
+        res = {true, 0};
+    } else {
+        res = {false, greatest};
     }
-    void visit(const std::shared_ptr<BinaryOperator> &formula) final {
-        formula->left()->accept(*this);
-        formula->right()->accept(*this);
+
+    delete model_ca;
+
+    return res;
+}
+
+// @param   formula is assumed to be CLTL[<=]
+// @param   modelname is the path to a .dve model
+unsigned int find_bound_min(const CltlFormulaPtr &formula, const std::string &modelname,
+                            BoundSearchStrategy strat, unsigned int jobs) {
+    assert(formula->is_infltl());
+    if (strat != BoundSearchStrategy::DIRECT) {
+        spaction::Logger<std::cerr>::instance().warning() << "only the dichotomic search is implemented for CLTL[<=] formulae" << std::endl;
     }
 
-    spot::ltl::atomic_prop_set get() const { return _res; }
+    // load the model once for all the probes
+    BoundSearchSession session(modelname, formula);
 
- private:
-    spot::ltl::atomic_prop_set _res;
-};
+    return find_bound_min_dichoto(formula, session, jobs);
+}
 
 // @param   formula is assumed to be CLTL[>]
 // @param   modelname is the path to a .dve model
 unsigned int find_bound_max(const CltlFormulaPtr &formula, const std::string &modelname,
-                            BoundSearchStrategy strat) {
+                            BoundSearchStrategy strat, unsigned int jobs) {
     assert(formula->is_supltl());
-    // get atomic propositions from formula
-    spot::bdd_dict bdd_dictionnary;
-    auto visitor = APCollector();
-    formula->accept(visitor);
-
-    spaction::Logger<std::cerr>::instance().info() << "atomic propositions collected" << std::endl;
-
-    spot::ltl::atomic_prop_set atomic_propositions = visitor.get();
-
-    // load divine model
-    spot::kripke *model = spot::load_dve2(modelname, &bdd_dictionnary, &atomic_propositions);
+    // load the model, with the atomic propositions of the formula
+    BoundSearchSession session(modelname, formula);
 
     spaction::Logger<std::cerr>::instance().info() << "Kripke model loaded" << std::endl;
 
     automata::value_t result;
     switch (strat) {
         case BoundSearchStrategy::CEGAR:
-            result = find_max_cegar(formula, model, &bdd_dictionnary);
+            result = find_max_cegar(formula, session);
             break;
         case BoundSearchStrategy::DIRECT:
-            result = find_max_direct(formula, model, &bdd_dictionnary);
+            result = find_max_direct(formula, session, jobs);
+            break;
+        case BoundSearchStrategy::BOUNDED:
+            result = find_max_bounded(formula, session, jobs);
             break;
     }
 
-    // delete the model
-    delete model;
     if (result.infinite)
         return -1;
     else
@@ -17,6 +17,7 @@
 
 #include <iostream>
 #include <getopt.h>
+#include <memory>
 #include <string>
 
 #include "CltlFormula.h"
@@ -142,8 +143,15 @@ void usage() {
         << "\t\tthe input model. <model> is the path to the DVE file." << std::endl;
     std::cerr << "Optional Arguments:" << std::endl;
     std::cerr << "\t-s <strat>, --strategy <strat>" << std::endl
-        << "\t\tthe strategy to use. Possible values for <strat> are \'direct\' and \'cegar\'." << std::endl
+        << "\t\tthe strategy to use. Possible values for <strat> are \'direct\', \'cegar\' and \'bounded\'." << std::endl
         << "\t\tDefault value is \'direct\'" << std::endl;
+    std::cerr << "\t-j <jobs>, --jobs <jobs>" << std::endl
+        << "\t\tthe number of bounds to probe in parallel, by the dichotomic searches." << std::endl
+        << "\t\tWith the direct strategy, the number of threads searching the supremum over" << std::endl
+        << "\t\tthe product, made explicit first, and translating top-level conjunctions." << std::endl
+        << "\t\tDefault value is 1" << std::endl;
+    std::cerr << "\t-a, --arena" << std::endl
+        << "\t\tallocates the formulae from an arena, released at once when the check ends." << std::endl;
     std::cerr << "\t-v <verb>, --verbosity <verb>" << std::endl
         << "\t\tthe verbosity level. <verb> should an integer between 0 and 4." << std::endl
         << "\t\t\t0 logs only fatal errors" << std::endl
@@ -159,6 +167,8 @@ int main(int argc, char* argv[]) {
     std::string cltl_string = "";
     std::string model_file = "";
     spaction::BoundSearchStrategy strategy = spaction::BoundSearchStrategy::DIRECT;
+    unsigned int jobs = 1;
+    bool arena = false;
     spaction::Logger<std::cerr>::LogLevel log_level = spaction::Logger<std::cerr>::LogLevel::kINFO;
 
     static struct option long_options[] = {
@@ -171,14 +181,18 @@ int main(int argc, char* argv[]) {
         /// the path to a dve file containing the model to check
         {"model",       required_argument,  0, 'm'},
         /// the strategy to use
-        ///     valid arguments are 'cegar' and 'direct'
+        ///     valid arguments are 'cegar', 'direct' and 'bounded'
         {"strategy",    required_argument,  0, 's'},
+        /// the number of bounds to probe in parallel
+        {"jobs",        required_argument,  0, 'j'},
+        /// allocates the formulae from an arena (see CltlFormulaFactory::kArenaAllocation)
+        {"arena",       no_argument,        0, 'a'},
         /// end of array
         {0, 0, 0, 0}
     };
 
     while (1) {
-        int c = getopt_long(argc, argv, "f:m:s:v", long_options, nullptr);
+        int c = getopt_long(argc, argv, "f:m:s:j:av", long_options, nullptr);
         // no more options to parse
         if (c == -1)
             break;
@@ -195,11 +209,24 @@ int main(int argc, char* argv[]) {
                     strategy = spaction::BoundSearchStrategy::DIRECT;
                 } else if (std::string("CEGAR") == optarg) {
                     strategy = spaction::BoundSearchStrategy::CEGAR;
+                } else if (std::string("BOUNDED") == optarg) {
+                    strategy = spaction::BoundSearchStrategy::BOUNDED;
                 } else {
                     spaction::Logger<std::cerr>::instance().error() << "unknown strategy "
                         << optarg << std::endl << "use default strategy instead" << std::endl;
                 }
                 break;
+            case 'j':
+                jobs = std::stoul(optarg);
+                if (!jobs) {
+                    spaction::Logger<std::cerr>::instance().error() << "invalid number of jobs "
+                        << optarg << std::endl << "use a single job instead" << std::endl;
+                    jobs = 1;
+                }
+                break;
+            case 'a':
+                arena = true;
+                break;
             case 'v':
                 if (optarg)
                     log_level = static_cast<spaction::Logger<std::cerr>::LogLevel>(optarg[0] - 'a');
@@ -221,7 +248,16 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    spaction::CltlFormulaPtr f = spaction::cltlparse::parse_formula(cltl_string);
+    // the arena factory must outlive every formula built from the input formula
+    std::unique_ptr<spaction::CltlFormulaFactory> arena_factory;
+    spaction::CltlFormulaPtr f = nullptr;
+    if (arena) {
+        arena_factory.reset(new spaction::CltlFormulaFactory(
+            spaction::CltlFormulaFactory::kArenaAllocation));
+        f = spaction::cltlparse::parse_formula(cltl_string, *arena_factory);
+    } else {
+        f = spaction::cltlparse::parse_formula(cltl_string);
+    }
     if (f == nullptr) {
         spaction::Logger<std::cerr>::instance().fatal() << "formula parsing went wrong, abort" << std::endl;
         return 1;
@@ -248,7 +284,7 @@ int main(int argc, char* argv[]) {
 //    }
     //@}
 
-    unsigned int result = spaction::find_bound_max(f, model_file, strategy);
+    unsigned int result = spaction::find_bound_max(f, model_file, strategy, jobs);
 
     std::cout << "the max bound is " << result << std::endl;
 